@@ -0,0 +1,78 @@
+#!/bin/sh
+# Queue and teller benchmark.
+#
+# Generates a synthetic customer file, then runs the program with the
+# sleeps disabled (-n) for every queue type, producer and teller count and
+# queue size,
+# and writes the throughput and latency of each run to a CSV file. If a
+# baseline CSV exists the results are compared with it, and the script
+# fails if any run regressed by more than BENCH_THRESHOLD percent.
+#
+# Run it with "make bench". The sweep is set by these variables:
+# BENCH_CUSTOMERS - The number of customers per run.
+# BENCH_MIX - The W:D:I mix of the customers.
+# BENCH_QUEUES - The queue types.
+# BENCH_PRODUCERS - The customer thread counts.
+# BENCH_TELLERS - The teller counts.
+# BENCH_SIZES - The queue sizes (m).
+# BENCH_RUNS - The number of runs of each configuration; the run with the
+#              median ops/sec is kept.
+# BENCH_THRESHOLD - The regression threshold, in percent.
+# BENCH_BASELINE - The baseline CSV.
+# BENCH_DIR - The directory the runs are made in.
+
+set -e
+
+EXEC=$(cd "$(dirname "$0")/.." && pwd)/bin/assignment
+BENCH=$(cd "$(dirname "$0")" && pwd)
+
+BENCH_CUSTOMERS=${BENCH_CUSTOMERS:-1000000}
+BENCH_MIX=${BENCH_MIX:-1:1:1}
+BENCH_QUEUES=${BENCH_QUEUES:-"mutex lockfree steal"}
+BENCH_PRODUCERS=${BENCH_PRODUCERS:-"1 2"}
+BENCH_TELLERS=${BENCH_TELLERS:-"1 2 4 8"}
+BENCH_SIZES=${BENCH_SIZES:-"16 1024"}
+BENCH_RUNS=${BENCH_RUNS:-3}
+BENCH_THRESHOLD=${BENCH_THRESHOLD:-10}
+BENCH_BASELINE=${BENCH_BASELINE:-$BENCH/baseline.csv}
+BENCH_DIR=${BENCH_DIR:-build/bench}
+
+case $BENCH_BASELINE in
+    /*) ;;
+    *) BENCH_BASELINE=$(pwd)/$BENCH_BASELINE ;;
+esac
+
+mkdir -p "$BENCH_DIR"
+RESULTS=$(cd "$BENCH_DIR" && pwd)/results.csv
+
+# The runs write c_file, r_log and debug in the bench directory.
+cd "$BENCH_DIR"
+
+echo "Generating $BENCH_CUSTOMERS customers ($BENCH_MIX)..."
+awk -v n="$BENCH_CUSTOMERS" -v mix="$BENCH_MIX" -f "$BENCH/gen.awk" > c_file
+
+echo "queue,producers,tellers,m,customers,seconds,ops_per_sec,locks_per_customer,wait_p50_us,wait_p99_us,total_p50_us,total_p99_us,total_p999_us" > "$RESULTS"
+for queue in $BENCH_QUEUES; do
+    for producers in $BENCH_PRODUCERS; do
+        for tellers in $BENCH_TELLERS; do
+            for m in $BENCH_SIZES; do
+                : > runs.csv
+                run=0
+                while [ $run -lt "$BENCH_RUNS" ]; do
+                    "$EXEC" -n -b -q "$queue" -p "$producers" -t "$tellers" "$m" 1 1 1 1 >> runs.csv
+                    run=$((run + 1))
+                done
+                line=$(sort -t, -k3 -n runs.csv | sed -n "$(((BENCH_RUNS + 1) / 2))p")
+                echo "$queue,$producers,$tellers,$m,$line" | tee -a "$RESULTS"
+            done
+        done
+    done
+done
+echo "Results written to $RESULTS"
+
+if [ -f "$BENCH_BASELINE" ]; then
+    echo "Comparing with $BENCH_BASELINE (threshold $BENCH_THRESHOLD%)..."
+    awk -F, -v threshold="$BENCH_THRESHOLD" -f "$BENCH/compare.awk" "$BENCH_BASELINE" "$RESULTS"
+else
+    echo "No baseline at $BENCH_BASELINE; run \"make bench-baseline\" to save these results as one."
+fi
@@ -0,0 +1,53 @@
+# Benchmark regression check.
+#
+# Usage: awk -F, -v threshold=<percent> -f bench/compare.awk baseline.csv results.csv
+#
+# Every run in the results is matched with the run of the same queue,
+# producers, tellers and m in the baseline. A run is a regression if its
+# ops/sec dropped, or its total p99 latency rose, by more than threshold
+# percent. The script prints one line per matched run and exits with 1 if
+# any run regressed.
+
+FNR == 1 {
+    # Find the columns by name, so the CSV can gain columns later.
+    for (i = 1; i <= NF; i++) {
+        col[$i] = i
+    }
+    next
+}
+
+{
+    key = $col["queue"] "," $col["producers"] "," $col["tellers"] "," $col["m"]
+}
+
+NR == FNR {
+    base_ops[key] = $col["ops_per_sec"]
+    base_p99[key] = $col["total_p99_us"]
+    next
+}
+
+{
+    if (!(key in base_ops)) {
+        printf "%-24s new run, no baseline\n", key
+        next
+    }
+
+    ops = $col["ops_per_sec"]
+    p99 = $col["total_p99_us"]
+    d_ops = base_ops[key] > 0 ? (ops - base_ops[key]) * 100 / base_ops[key] : 0
+    d_p99 = base_p99[key] > 0 ? (p99 - base_p99[key]) * 100 / base_p99[key] : 0
+
+    status = "ok"
+    if (d_ops < -threshold || d_p99 > threshold) {
+        status = "REGRESSION"
+        regressions++
+    }
+    printf "%-24s ops/sec %+7.1f%%  total p99 %+7.1f%%  %s\n", key, d_ops, d_p99, status
+}
+
+END {
+    if (regressions > 0) {
+        printf "%d run(s) regressed by more than %s%%.\n", regressions, threshold
+        exit 1
+    }
+}
@@ -0,0 +1,35 @@
+# Synthetic customer file generator for the benchmark.
+#
+# Usage: awk -v n=<customers> -v mix=<W:D:I> -v seed=<seed> -f bench/gen.awk > c_file
+#
+# n    - The number of customers to generate (default 1000000).
+# mix  - The relative share of withdrawals, deposits and information
+#        queries (default 1:1:1).
+# seed - The seed for the service type sequence (default 1).
+#
+# The customers have no arrival times, as the benchmark runs with -n.
+
+BEGIN {
+    if (n == "") n = 1000000
+    if (mix == "") mix = "1:1:1"
+    if (seed == "") seed = 1
+
+    if (split(mix, w, ":") != 3 || w[1] + w[2] + w[3] <= 0) {
+        print "gen.awk: mix must be W:D:I with a positive total" > "/dev/stderr"
+        exit 1
+    }
+    total = w[1] + w[2] + w[3]
+    srand(seed)
+
+    for (i = 1; i <= n; i++) {
+        r = rand() * total
+        if (r < w[1]) {
+            type = "W"
+        } else if (r < w[1] + w[2]) {
+            type = "D"
+        } else {
+            type = "I"
+        }
+        print i, type
+    }
+}
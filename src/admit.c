@@ -0,0 +1,107 @@
+#include "admit.h"
+#include <stdlib.h> /* For strtod() */
+#include <string.h>
+
+/*************************************************************************
+ *                          Admission Functions                          *
+ *************************************************************************/
+
+/*************************************************************************
+ * Admit Parse Function.
+ *
+ * This function reads one overload behaviour as given on the command
+ * line and sets it in a, leaving the others as they are: "balk" or
+ * "balk:<depth>", "renege:<ms>" or "bucket:<rate>[:<burst>]". The burst
+ * is one second of the rate if it is not given.
+ *
+ * @param arg - The argument.
+ * @param a - The overload behaviour to be updated.
+ * @return int - 0 on success, 1 if the argument is not valid.
+ *************************************************************************/
+int admit_parse(const char *arg, admit_t *a) {
+    const char *p = strchr(arg, ':');
+    size_t len = p == NULL ? strlen(arg) : (size_t) (p - arg);
+    char name[8] = "";
+    double values[2] = {0, 0};
+    double x, y;
+    char *end;
+    int n = 1; /* The number of fields, counting the name. */
+
+    if (len >= sizeof(name)) {
+        return 1;
+    }
+    memcpy(name, arg, len);
+    while (p != NULL) {
+        if (n == 3) {
+            return 1;
+        }
+        values[n - 1] = strtod(p + 1, &end);
+        if (end == p + 1 || (*end != ':' && *end != '\0')) {
+            return 1;
+        }
+        n++;
+        p = *end == ':' ? end : NULL;
+    }
+    x = values[0];
+    y = values[1];
+
+    if (strcmp(name, "balk") == 0 && (n == 1 || n == 2)) {
+        if (n == 2 && x < 1) {
+            return 1;
+        }
+        a->balk = n == 2 ? (int) x : ADMIT_FULL;
+    } else if (strcmp(name, "renege") == 0 && n == 2 && x > 0) {
+        a->patience = (long) (x * 1e6);
+    } else if (strcmp(name, "bucket") == 0 && (n == 2 || n == 3) && x > 0) {
+        if (n == 3 && y < 1) {
+            return 1;
+        }
+        a->rate = x;
+        a->burst = n == 3 ? y : (x > 1 ? x : 1);
+    } else {
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Bucket Init Function.
+ *
+ * @param b - The bucket to be initialized, full.
+ * @param a - The overload behaviour, with the total rate and burst of all
+ *            the producers.
+ * @param shards - The number of producers, which share them equally.
+ * @param now - The current time, in ns.
+ * @return void
+ *************************************************************************/
+void bucket_init(bucket_t *b, const admit_t *a, int shards, long now) {
+    b->rate = a->rate / shards / 1e9;
+    b->burst = a->burst / shards > 1 ? a->burst / shards : 1;
+    b->tokens = b->burst;
+    b->last = now;
+}
+
+/*************************************************************************
+ * Bucket Take Function.
+ *
+ * This function tops the bucket up for the time since it was last used,
+ * then takes a token for one customer if there is one.
+ *
+ * @param b - The bucket.
+ * @param now - The current time, in ns.
+ * @return int - 1 if the customer is admitted, 0 if it is rejected.
+ *************************************************************************/
+int bucket_take(bucket_t *b, long now) {
+    if (now > b->last) {
+        b->tokens += (now - b->last) * b->rate;
+        if (b->tokens > b->burst) {
+            b->tokens = b->burst;
+        }
+        b->last = now;
+    }
+    if (b->tokens < 1) {
+        return 0;
+    }
+    b->tokens -= 1;
+    return 1;
+}
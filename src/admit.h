@@ -0,0 +1,60 @@
+#ifndef OS_ASSIGNMENT_20183622_ADMIT_H
+#define OS_ASSIGNMENT_20183622_ADMIT_H
+
+#define ADMIT_FULL (-1) /* Balk only when the queue is full, whatever its size. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for the overload behaviour of a run.
+ *
+ * Each part is off when it is 0, and any of them can be combined. A
+ * customer that balks or is rejected never joins the queue; one that
+ * reneges leaves it without being served.
+ *
+ * @param balk - The queue depth at which arriving customers balk, or
+ *               ADMIT_FULL for the size of the queue.
+ * @param patience - How long a customer waits in the queue before it
+ *                   reneges, in ns.
+ * @param rate - The token bucket's rate of admissions, per second.
+ * @param burst - The token bucket's size, in customers.
+ *************************************************************************/
+typedef struct admit {
+    int balk;
+    long patience;
+    double rate;
+    double burst;
+} admit_t; /* Admission struct. */
+
+/*************************************************************************
+ * Struct for a token bucket.
+ *
+ * Each producer has its own bucket with its share of the rate and the
+ * burst, as it has its own share of the arrivals, so admission takes no
+ * lock.
+ *
+ * @param tokens - The admissions available now.
+ * @param rate - The tokens added per ns.
+ * @param burst - The most tokens the bucket holds.
+ * @param last - The time the tokens were last added, in ns.
+ *************************************************************************/
+typedef struct bucket {
+    double tokens;
+    double rate;
+    double burst;
+    long last;
+} bucket_t; /* Token bucket struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int admit_parse(const char *arg, admit_t *a);
+
+void bucket_init(bucket_t *b, const admit_t *a, int shards, long now);
+
+int bucket_take(bucket_t *b, long now);
+
+#endif /*OS_ASSIGNMENT_20183622_ADMIT_H*/
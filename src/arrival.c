@@ -0,0 +1,79 @@
+#include "arrival.h"
+#include <stdlib.h> /* For strtod() */
+#include <string.h>
+
+/*************************************************************************
+ *                           Arrival Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Arrival Init Function.
+ *
+ * @param a - The schedule to be initialized.
+ * @param spacing - ARRIVAL_POISSON or ARRIVAL_FIXED.
+ * @param rate - The total arrival rate of all the producers, per second.
+ * @param shard - The index of the producer.
+ * @param shards - The number of producers.
+ * @param seed - The seed for the Poisson gaps. Each producer draws from
+ *               its own generator, seeded with seed + shard.
+ * @return void
+ *************************************************************************/
+void arrival_init(arrival_t *a, int spacing, double rate, int shard, int shards, unsigned long seed) {
+    a->spacing = spacing;
+    a->gap = shards * 1e9 / rate;
+    rng_seed(&a->rng, seed + shard);
+
+    /* The first arrival. Fixed schedules are offset so that the producers take turns. */
+    if (spacing == ARRIVAL_FIXED) {
+        a->next = shard * 1e9 / rate;
+    } else {
+        a->next = rng_exponential(&a->rng, a->gap);
+    }
+}
+
+/*************************************************************************
+ * Arrival Next Function.
+ *
+ * @param a - The schedule.
+ * @return long - The time of the next arrival, in ns from the start of the run.
+ *************************************************************************/
+long arrival_next(arrival_t *a) {
+    long at = (long) a->next;
+
+    if (a->spacing == ARRIVAL_FIXED) {
+        a->next += a->gap;
+    } else {
+        a->next += rng_exponential(&a->rng, a->gap);
+    }
+    return at;
+}
+
+/*************************************************************************
+ * Arrival Parse Function.
+ *
+ * This function reads an arrival rate as given on the command line, e.g.
+ * "2.5", "100000:poisson" or "50:fixed". The spacing is Poisson if it is
+ * not given.
+ *
+ * @param arg - The argument.
+ * @param rate - Filled with the rate, per second.
+ * @param spacing - Filled with ARRIVAL_POISSON or ARRIVAL_FIXED.
+ * @return int - 0 on success, 1 if the argument is not valid.
+ *************************************************************************/
+int arrival_parse(const char *arg, double *rate, int *spacing) {
+    char *end;
+
+    *rate = strtod(arg, &end);
+    if (end == arg || *rate <= 0) {
+        return 1;
+    }
+
+    if (*end == '\0' || strcmp(end, ":poisson") == 0) {
+        *spacing = ARRIVAL_POISSON;
+    } else if (strcmp(end, ":fixed") == 0) {
+        *spacing = ARRIVAL_FIXED;
+    } else {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef OS_ASSIGNMENT_20183622_ARRIVAL_H
+#define OS_ASSIGNMENT_20183622_ARRIVAL_H
+
+#include "rng.h"
+
+#define ARRIVAL_POISSON 0 /* Exponential gaps between the arrivals. */
+#define ARRIVAL_FIXED 1 /* The same gap between every two arrivals. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for an open-loop arrival schedule.
+ *
+ * The arrival times are fixed by the rate alone, whatever happens to the
+ * queue. A producer that falls behind its schedule is late, and that
+ * lateness is recorded instead of being dropped from the offered load.
+ * The producers split the rate between them: with Poisson spacing each
+ * runs a Poisson process at rate / shards, and with fixed spacing their
+ * arrivals interleave.
+ *
+ * @param spacing - ARRIVAL_POISSON or ARRIVAL_FIXED.
+ * @param gap - The mean time between two arrivals of this schedule, in ns.
+ * @param next - The time of the next arrival, in ns from the start of the run.
+ * @param rng - The generator for the Poisson gaps.
+ *************************************************************************/
+typedef struct arrival {
+    int spacing;
+    double gap;
+    double next;
+    rng_t rng;
+} arrival_t; /* Arrival schedule struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+void arrival_init(arrival_t *a, int spacing, double rate, int shard, int shards, unsigned long seed);
+
+long arrival_next(arrival_t *a);
+
+int arrival_parse(const char *arg, double *rate, int *spacing);
+
+#endif /*OS_ASSIGNMENT_20183622_ARRIVAL_H*/
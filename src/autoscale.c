@@ -0,0 +1,165 @@
+#include "autoscale.h"
+
+/*************************************************************************
+ *                           Autoscale Functions                         *
+ *************************************************************************/
+
+/*************************************************************************
+ * Autoscale Init Function.
+ *
+ * @param a - The controller to be initialized.
+ * @param min - The fewest tellers.
+ * @param max - The most tellers.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int autoscale_init(autoscale_t *a, int min, int max) {
+    int i; /* Loop counter. */
+
+    memset(a, 0, sizeof(autoscale_t));
+    a->min = min;
+    a->max = max;
+
+    a->slots = calloc(max, sizeof(autoscale_slot_t));
+    a->window = calloc(1, sizeof(hist_t));
+    if (a->slots == NULL || a->window == NULL) {
+        printf("Error: Failed to allocate the autoscaler.\n");
+        free(a->slots);
+        free(a->window);
+        return 1;
+    }
+
+    for (i = 0; i < max; i++) {
+        pthread_mutex_init(&a->slots[i].mutex, NULL);
+    }
+
+    return 0;
+}
+
+/*************************************************************************
+ * Autoscale Destroy Function.
+ *
+ * @param a - The controller to be destroyed.
+ * @return void
+ *************************************************************************/
+void autoscale_destroy(autoscale_t *a) {
+    int i; /* Loop counter. */
+
+    for (i = 0; i < a->max; i++) {
+        pthread_mutex_destroy(&a->slots[i].mutex);
+    }
+    free(a->slots);
+    free(a->window);
+}
+
+/*************************************************************************
+ * Autoscale Record Function.
+ *
+ * This function records the queue wait and service time of a customer for
+ * the next sample.
+ *
+ * @param a - The controller.
+ * @param teller - The index of the teller that served the customer.
+ * @param wait - The time the customer waited in the queue, in ns.
+ * @param service - The time the customer was served for, in ns.
+ * @return void
+ *************************************************************************/
+void autoscale_record(autoscale_t *a, int teller, long wait, long service) {
+    autoscale_slot_t *slot = &a->slots[teller];
+
+    pthread_mutex_lock(&slot->mutex);
+    hist_record(&slot->wait, wait);
+    slot->service += (double) service;
+    pthread_mutex_unlock(&slot->mutex);
+}
+
+/*************************************************************************
+ * Autoscale Sample Function.
+ *
+ * This function takes a sample of the load and decides how many tellers
+ * there should be. A scale-up needs AUTOSCALE_UP_TICKS samples in a row
+ * where more than AUTOSCALE_UP_DEPTH customers wait per teller, or the
+ * p99 queue wait is longer than the mean service time. A scale-down needs
+ * AUTOSCALE_DOWN_TICKS samples in a row with an empty queue and so few
+ * arrivals that one teller fewer would be less than AUTOSCALE_DOWN_UTIL
+ * busy. The counts start again after every change.
+ *
+ * @param a - The controller.
+ * @param tellers - The number of tellers now.
+ * @param depth - The number of customers waiting.
+ * @param arrivals - The number of customers that have arrived so far.
+ * @param elapsed - The time since the last sample, in ns.
+ * @param reason - Filled with the reason for the decision and the load,
+ *                 for the log. Must hold MSG_LEN characters.
+ * @return int - The number of tellers there should be.
+ *************************************************************************/
+int autoscale_sample(autoscale_t *a, int tellers, int depth, unsigned long arrivals, long elapsed, char *reason) {
+    double service = 0; /* The total service time of the sample, in ns. */
+    double busy; /* The estimated number of busy tellers. */
+    unsigned long p99; /* The p99 queue wait of the sample, in ns. */
+    int target = tellers;
+    int i; /* Loop counter. */
+
+    /* Collect the latencies the tellers recorded since the last sample. */
+    memset(a->window, 0, sizeof(hist_t));
+    for (i = 0; i < a->max; i++) {
+        pthread_mutex_lock(&a->slots[i].mutex);
+        hist_merge(a->window, &a->slots[i].wait);
+        service += a->slots[i].service;
+        memset(&a->slots[i].wait, 0, sizeof(hist_t));
+        a->slots[i].service = 0;
+        pthread_mutex_unlock(&a->slots[i].mutex);
+    }
+    p99 = hist_percentile(a->window, 99.0);
+
+    /* Update the averages. The first service time is taken as it is. */
+    if (elapsed > 0) {
+        a->rate += AUTOSCALE_ALPHA * ((arrivals - a->arrivals) * 1e9 / elapsed - a->rate);
+    }
+    a->arrivals = arrivals;
+    if (a->window->count > 0) {
+        service /= a->window->count;
+        a->service = a->service == 0 ? service : a->service + AUTOSCALE_ALPHA * (service - a->service);
+    }
+    busy = a->rate * a->service / 1e9;
+
+    if (tellers < a->max && depth > AUTOSCALE_UP_DEPTH * tellers) {
+        a->down_ticks = 0;
+        if (++a->up_ticks >= AUTOSCALE_UP_TICKS) {
+            target = tellers + 1;
+            sprintf(reason, "queue over %d per teller", AUTOSCALE_UP_DEPTH);
+        }
+    } else if (tellers < a->max && depth > 0 && a->window->count > 0 && p99 > a->service) {
+        a->down_ticks = 0;
+        if (++a->up_ticks >= AUTOSCALE_UP_TICKS) {
+            target = tellers + 1;
+            sprintf(reason, "wait p99 over the service time");
+        }
+    } else if (tellers > a->min && depth == 0 && busy < (tellers - 1) * AUTOSCALE_DOWN_UTIL) {
+        a->up_ticks = 0;
+        if (++a->down_ticks >= AUTOSCALE_DOWN_TICKS) {
+            target = tellers - 1;
+            sprintf(reason, "spare tellers");
+        }
+    } else {
+        a->up_ticks = 0;
+        a->down_ticks = 0;
+    }
+
+    if (target == tellers) {
+        return tellers;
+    }
+
+    /* After a burst, add enough tellers for the estimated load at once. */
+    if (target > tellers && busy > target) {
+        target = (int) busy + 1;
+    }
+    if (target > a->max) {
+        target = a->max;
+    }
+
+    a->up_ticks = 0;
+    a->down_ticks = 0;
+    sprintf(reason + strlen(reason), ": queue %d, %.2f arrivals/s, %.2f tellers busy, wait p99 %.3f ms, service %.3f ms",
+            depth, a->rate, busy, p99 / 1e6, a->service / 1e6);
+    return target;
+}
@@ -0,0 +1,79 @@
+#ifndef OS_ASSIGNMENT_20183622_AUTOSCALE_H
+#define OS_ASSIGNMENT_20183622_AUTOSCALE_H
+
+#include "standard.h"
+
+#define AUTOSCALE_PERIOD_NS 200000000L /* The controller samples the queue every 200ms. */
+#define AUTOSCALE_UP_DEPTH 2 /* Scale up when more customers than this wait per teller. */
+#define AUTOSCALE_UP_TICKS 2 /* Scale up once the queue has been too deep for this many samples. */
+#define AUTOSCALE_DOWN_UTIL 0.5 /* Scale down when one teller fewer would be less than half busy. */
+#define AUTOSCALE_DOWN_TICKS 25 /* Scale down once the tellers have been idle enough for this many samples. */
+#define AUTOSCALE_ALPHA 0.3 /* The weight of the newest sample in the arrival rate and service time averages. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for the latencies a teller recorded since the last sample.
+ *
+ * Each teller writes only its own slot, so the lock is only contended
+ * when the controller takes the sample.
+ *
+ * @param mutex - The lock for this slot.
+ * @param wait - The queue waits recorded since the last sample.
+ * @param service - The total service time recorded since the last sample, in ns.
+ * @param pad - Keeps the slots of different tellers on separate cache lines.
+ *************************************************************************/
+typedef struct autoscale_slot {
+    pthread_mutex_t mutex;
+    hist_t wait;
+    double service;
+    char pad[CACHE_LINE];
+} autoscale_slot_t; /* Autoscale slot struct. */
+
+/*************************************************************************
+ * Struct for a teller autoscaling controller.
+ *
+ * The controller estimates how many tellers are busy from the arrival
+ * rate and the mean service time (Little's law), and watches the queue
+ * depth and the p99 queue wait of the last sample. It adds a teller when
+ * the queue stays deep or the waits outgrow the service time, and removes
+ * one only after the tellers have had spare capacity for a while, so a
+ * short lull does not undo a scale-up.
+ *
+ * @param min - The fewest tellers.
+ * @param max - The most tellers.
+ * @param slots - The latencies each teller recorded since the last sample.
+ * @param window - The merged queue waits of the last sample.
+ * @param rate - The average arrival rate, in customers per second.
+ * @param service - The average service time, in ns.
+ * @param arrivals - The number of arrivals at the last sample.
+ * @param up_ticks - The number of samples in a row the queue has been too deep.
+ * @param down_ticks - The number of samples in a row the tellers have had spare capacity.
+ *************************************************************************/
+typedef struct autoscale {
+    int min;
+    int max;
+    autoscale_slot_t *slots;
+    hist_t *window;
+    double rate;
+    double service;
+    unsigned long arrivals;
+    int up_ticks;
+    int down_ticks;
+} autoscale_t; /* Autoscale struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int autoscale_init(autoscale_t *a, int min, int max);
+
+void autoscale_destroy(autoscale_t *a);
+
+void autoscale_record(autoscale_t *a, int teller, long wait, long service);
+
+int autoscale_sample(autoscale_t *a, int tellers, int depth, unsigned long arrivals, long elapsed, char *reason);
+
+#endif /*OS_ASSIGNMENT_20183622_AUTOSCALE_H*/
@@ -1,620 +1,2176 @@
-#include "standard.h"
-
-/*************************************************************************
- *                            Macro Definitions                          *
- *************************************************************************/
-
-#define TRUE 1
-#define FALSE 0
-#define T_THREADS 4 /* Number of teller threads to be created. */
-#define C_THREADS 1 /* Number of customer threads to be created. */
-#define DEBUG_FILE "debug" /* The name of the debug file. */
-#define LOG_FILE "r_log" /* The name of the log file. */
-#define CUSTOMER_FILE "c_file" /* The name of the customer file. */
-
-/*************************************************************************
- *                            Global Variables                           *
- *************************************************************************/
-
-FILE *log_file = NULL;
-FILE *debug_file = NULL;
-FILE *c_file = NULL;
-
-pthread_mutex_t debug_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the debug access. */
-pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the log access. */
-pthread_mutex_t file_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the file access. */
-
-int end_of_file = FALSE; /* Flag to indicate if the end of the file has been reached. */
-customer_queue_t c_queue; /* The customer queue. */
-
-int t_I; /* The time duration of an information query. */
-int t_C; /* The customer arrival period. */
-int t_W; /* The time duration of a withdrawal. */
-int t_D; /* The time duration of a deposit. */
-
-teller_t *tellers; /* Array of tellers. */
-
-pthread_t t_threads[T_THREADS]; /* Array of teller threads. */
-pthread_t c_threads[C_THREADS]; /* Array of customer threads. */
-
-int t_thread_numbers[T_THREADS]; /* Number of teller threads created (e.g., [ 1, 2, 3, 4 ]). */
-int c_thread_numbers[C_THREADS]; /* Number of customer threads created. */
-
-/*************************************************************************
- *                             Main Function                             *
- *************************************************************************/
-
-/*************************************************************************
- * Main Function.
- *
- * This function is the entry point of the program. It creates the teller and
- * customer threads and then waits for them to finish.
- *
- * @param argc - The number of arguments passed to the program.
- * @param argv - The arguments passed to the program.
- *           argv[0] - The file name of the program.
- *           argv[1] - The size/length of the customer queue (m).
- *           argv[2] - The customer arrival period (t_C).
- *           argv[3] - The time duration of a withdrawal (t_W).
- *           argv[4] - The time duration of a deposit (t_D).
- *           argv[5] - The time duration of an information query (t_I).
- * @return int - The exit code of the program.
- *************************************************************************/
-int main(int argc, char *argv[]) {
-    int i; /* Loop counter. */
-    int teller_total = 0; /* Total number of customers served by all tellers. */
-    char *msg = malloc(sizeof(char) * 100);
-
-    /* Open the debug and log file. */
-    debug_file = fopen(DEBUG_FILE, "w");
-    log_file = fopen(LOG_FILE, "w");
-
-    /* Initialize the log and debug mutexes. */
-    pthread_mutex_init(&log_mutex, NULL);
-    pthread_mutex_init(&debug_mutex, NULL);
-
-    /* Register the SIGINT signal handler. */
-    if (signal(SIGINT, sig_handler) == SIG_ERR) {
-        printf("Error: Failed to register the SIGINT signal handler.\n");
-    }
-
-    /*************************************************************************
-     * Check the arguments passed to the program.
-     *************************************************************************/
-
-    /* Check if the correct number of arguments were passed. */
-    if (argc != 6) {
-        printf("Usage: %s <m> <t_C> <t_W> <t_D> <t_I>\n", argv[0]);
-        printf("  m  - The size/length of the customer queue.\n");
-        printf("  t_C - The customer arrival period.\n");
-        printf("  t_W - The time duration of a withdrawal.\n");
-        printf("  t_D - The time duration of a deposit.\n");
-        printf("  t_I - The time duration of an information query.\n");
-        printf("\nExample: %s 100 5 2 2 1\n", argv[0]);
-        return 1; /* Exit with error code 1. */
-    } else {
-        sprintf(msg, "The number of arguments passed: %d", argc);
-        sprintf(msg, "The arguments passed to the program:");
-        for (i = 0; i < argc; i++) {
-            sprintf(msg, "  argv[%d] = %s", i, argv[i]);
-        }
-    }
-
-    /* Get the queue size. */
-    c_queue.size = atoi(argv[1]);
-
-    /* Get the time periods. */
-    t_C = atoi(argv[2]);
-    t_W = atoi(argv[3]);
-    t_D = atoi(argv[4]);
-    t_I = atoi(argv[5]);
-
-    /* Check that the queue size is greater than 0. */
-    if (c_queue.size <= 0) {
-        printf("Error: The queue size must be greater than 0.\n");
-        printf("Entered queue size: %d\n", c_queue.size);
-        printf("Usage: %s <m> <t_C> <t_W> <t_D> <t_I>\n", argv[0]);
-        return 1; /* Exit with error code 1. */
-    }
-
-    /* Check that the time periods are all greater or equal to 1 */
-    if (t_C < 1 || t_W < 1 || t_D < 1 || t_I < 1) {
-        printf("Error: All time periods must be greater than or equal to 1.\n");
-        printf("Entered time periods: t_C=%d, t_W=%d, t_D=%d, t_I=%d\n", t_C, t_W, t_D, t_I);
-        printf("Usage: %s <m> <t_C> <t_W> <t_D> <t_I>\n", argv[0]);
-        return 1; /* Exit with error code 1. */
-    }
-
-    /*************************************************************************
-     * Initialize the customer queue.
-     *************************************************************************/
-    
-    /* Initialize the customer queue mutex. */
-    if (pthread_mutex_init(&c_queue.mutex, NULL) != 0) {
-        printf("Error: Failed to initialize the customer queue mutex.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    /* Initialize the customer queue condition variables. */
-    if (pthread_cond_init(&c_queue.empty, NULL) != 0) {
-        printf("Error: Failed to initialize the customer queue empty condition variable.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    if (pthread_cond_init(&c_queue.full, NULL) != 0) {
-        printf("Error: Failed to initialize the customer queue full condition variable.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    /* Initialize the customer queue variables. */
-    c_queue.in = 0;
-    c_queue.out = 0;
-    c_queue.count = 0;
-    c_queue.q = malloc(sizeof(struct customer) * c_queue.size);
-
-    /*************************************************************************
-     * Initialize the mutexes.
-     *************************************************************************/
-
-
-    if (pthread_mutex_init(&c_queue.mutex, NULL) != 0) {
-        printf("Error: Failed to initialize the queue mutex.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-
-    if (pthread_mutex_init(&file_mutex, NULL) != 0) {
-        printf("Error: Failed to initialize the teller mutex.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    /*************************************************************************
-     * Initialize the condition variables.
-     *************************************************************************/
-
-    /* Initialize the condition variables. */
-    if (pthread_cond_init(&c_queue.full, NULL) != 0) {
-        printf("Error: Failed to initialize the full condition variable.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    if (pthread_cond_init(&c_queue.empty, NULL) != 0) {
-        printf("Error: Failed to initialize the empty condition variable.\n");
-        return 1; /* Exit with error code 1. */
-    }
-
-    /* Create the teller threads. */
-    tellers = malloc(sizeof(struct teller) * T_THREADS);
-    for (i = 0; i < T_THREADS; i++) {
-
-        /* Allocate memory for the teller struct. */
-
-        /* Set the teller thread numbers. */
-        t_thread_numbers[i] = i;
-        sprintf(msg, "Creating teller thread %d...", i + 1);
-
-        /* Allocate memory for the teller struct. */
-
-        tellers[i].teller_number = i + 1;
-        tellers[i].customers_served = 0;
-
-        /* Set the teller start time. */
-        get_time(tellers[i].start_time);
-
-        /* The below line is initializing the teller thread with the teller function.
-         * pthread_create(<address of thread>, <thread attributes>, <teller function to run>, <teller struct>)
-         */
-        pthread_create(&t_threads[i], NULL, teller, (void *) &t_thread_numbers[i]);
-        sprintf(msg, "Created teller thread %d.", i + 1);
-    }
-
-    /* Create the customer threads. */
-    for (i = 0; i < C_THREADS; i++) {
-        c_thread_numbers[i] = i + 1;
-
-        /* The below line is initializing the customer thread with the customer function.
-         * pthread_create(<address of thread>, <thread attributes>, <customer function to run>, <filename>)
-         */
-        pthread_create(&c_threads[i], NULL, customer, (void *) CUSTOMER_FILE);
-
-        sprintf(msg, "Created customer thread %d.", i + 1);
-    }
-
-    /* Wait for the customer threads to finish. */
-    for (i = 0; i < C_THREADS; i++) {
-        pthread_join(c_threads[i], NULL);
-        sprintf(msg, "Joined customer thread %d.", i + 1);
-    }
-
-    /* Wait for the teller threads to finish. */
-    for (i = 0; i < T_THREADS; i++) {
-        pthread_join(t_threads[i], NULL);
-        sprintf(msg, "Joined teller thread %d.", i + 1);
-    }
-
-    /* Print the teller stats. */
-    wrt_log("Teller Statistic");
-    teller_total = 0;
-    for (i = 0; i < T_THREADS; i++) {
-        sprintf(msg, "Teller-%d serves %d customers.", tellers[i].teller_number, tellers[i].customers_served);
-        wrt_log(msg);
-        teller_total += tellers[i].customers_served;
-    }
-    sprintf(msg, "\nTotal customers served: %d\n", teller_total);
-    wrt_log(msg);
-
-    /* Close the file. */
-    fclose(c_file);
-
-    /*************************************************************************
-     * Print the results.
-     *************************************************************************/
-
-    free(tellers);
-
-    /* Free the memory. */
-    free(msg); /* Free the message string. */
-
-    /* Free the arrays. */
-    free(c_queue.q); /* Free the queue. */
-
-    /* Destroy the mutexes. */
-    pthread_mutex_destroy(&c_queue.mutex);
-
-    /* Destroy the condition variables. */
-    pthread_cond_destroy(&c_queue.full);
-    pthread_cond_destroy(&c_queue.empty);
-
-    /* Close the files. */
-    fclose(log_file);
-    fclose(debug_file);
-
-    return 0;
-}
-
-/*************************************************************************
- *                           Thread Functions                            *
- *************************************************************************/
-
-/*************************************************************************
- * Customer Producer Function.
- *
- * This function reads the c_file and creates the customers
- * based on the data in the file. It then adds the customers to the
- * shared queue and then sleep for t_C seconds.
- *
- * @param arg - The argument passed to the thread.
- * @return void* - The return value of the thread.
- *************************************************************************/
-void *customer(void *arg) {
-    char line[10] = {0}; /* The line read from the file. */
-    int customer_number;
-    char service_type;
-    char *arrive_time;
-    char *msg = malloc(sizeof(char) * 100);
-    c_file = fopen((char *) arg, "r"); /* Open the file. */
-
-    if (c_file == NULL) {
-        printf("Error opening file.\n");
-        exit(1);
-    }
-
-    do {
-        /* Sleep for t_C seconds. */
-        sleep(t_C);
-
-        if (fgets(line, 10, c_file) != NULL) {
-            /* Lock the queue. */
-            pthread_mutex_lock(&c_queue.mutex);
-
-            /*************************************************************************
-             *                           Critical Section                            *
-             *************************************************************************/
-
-            end_of_file = FALSE;
-
-            line[strlen(line) - 1] = '\0'; /* Remove the newline character. */
-
-            /* Read the customer number. */
-            sscanf(line, "%d %c", &customer_number, &service_type);
-
-            /* Wait for the queue to not be full. */
-            while (is_full() == TRUE) {
-                pthread_cond_wait(&c_queue.full, &c_queue.mutex);
-            }
-
-            /* Set the customer values. */
-            c_queue.q[c_queue.in].customer_number = customer_number;
-            c_queue.q[c_queue.in].service_type = service_type;
-
-            /* Get the current time. */
-            get_time(c_queue.q[c_queue.in].arrival_time);
-            arrive_time = c_queue.q[c_queue.in].arrival_time;
-
-            /* Print the customer information. */
-            wrt_log("-----------------------------------------------------------------------");
-            sprintf(msg, "Customer %d: %c\nArrival time: %s", customer_number, service_type, arrive_time);
-            wrt_log(msg);
-            wrt_log("-----------------------------------------------------------------------\n");
-
-
-            /* Increment the queue size. */
-            c_queue.count++;
-
-            /* Increment the queue in. */
-            c_queue.in = (c_queue.in + 1) % c_queue.size;
-
-            /*************************************************************************
-             *                        End of Critical Section                        *
-             *************************************************************************/
-
-            /* Signal that the queue is not empty. */
-            pthread_cond_signal(&c_queue.empty);
-
-            /* Unlock the queue. */
-            pthread_mutex_unlock(&c_queue.mutex);
-
-        } else if (feof(c_file) != 0) { /* The end of the file has been reached. */
-            pthread_mutex_lock(&c_queue.mutex);
-            end_of_file = TRUE;
-            /* Broadcast that the queue is not empty. This will wake up the tellers, and they will shut down. */
-            pthread_cond_broadcast(&c_queue.empty);
-            pthread_mutex_unlock(&c_queue.mutex);
-        } else if (ferror(c_file) != 0) { /* There was an error reading the file. */
-            printf("Error reading file.\n");
-            pthread_mutex_lock(&c_queue.mutex);
-            end_of_file = TRUE;
-            /* Broadcast that the queue is not empty. This will wake up the tellers, and they will shut down. */
-            pthread_cond_broadcast(&c_queue.empty);
-            pthread_mutex_unlock(&c_queue.mutex);
-            exit(1);
-        }
-
-    } while (end_of_file == FALSE);
-
-    /* Free the memory. */
-    free(msg);
-
-    /* Exit the thread. */
-    pthread_exit(NULL);
-    return NULL; /* This line is only here to prevent a warning. */
-}
-
-/*************************************************************************
- * Teller Consumer Function.
- *
- * This function is the entry point of the teller threads. It simulates
- * the teller serving customers. It is the consumer thread.
- *
- * @param arg - The teller struct.
- * @return void* - The teller struct.
- *************************************************************************/
-void *teller(void *arg) {
-    char *msg;
-    char response_time[9];
-    char completion_time[9];
-    int sleep_time;
-    int customer_number;
-    customer_t current_customer;
-    char service_type;
-
-    teller_t t; /* The teller struct. */
-
-    /* Allocate memory for the message string. */
-    msg = malloc(sizeof(char) * 100);
-
-    /* Get the teller struct. */
-    t = tellers[*((int *) arg)];
-
-    /* Loop until the end of the file has been reached and the queue is empty. */
-    do {
-        /* Lock the queue. */
-        pthread_mutex_lock(&c_queue.mutex);
-
-        /*************************************************************************
-         *                           Critical Section                            *
-         *************************************************************************/
-
-        /* Wait for the queue to not be empty. */
-        while (is_empty() == TRUE && end_of_file == FALSE) {
-            pthread_cond_wait(&c_queue.empty, &c_queue.mutex);
-        }
-
-        /* Check if the end of the file has been reached. */
-        if (end_of_file == TRUE && is_empty() == TRUE) {
-            /* Unlock the queue. */
-            pthread_mutex_unlock(&c_queue.mutex);
-            break;
-        } else {
-
-            /* Set the current customer. */
-            current_customer = c_queue.q[c_queue.out];
-
-            /* Set the customer values. */
-            customer_number = current_customer.customer_number; /* Get the customer number. */
-            service_type = current_customer.service_type; /* Get the service type. */
-
-            /* Get the current time. */
-            get_time(response_time);
-
-            /* Log the customer. */
-            sprintf(msg, "Teller: %d\nCustomer: %d\nService: %c\nArrival Time: %s\nResponse Time: %s\n",
-                    t.teller_number, customer_number, service_type, current_customer.arrival_time, response_time);
-            wrt_log(msg);
-
-            /* Increment the queue out. */
-            c_queue.out = (c_queue.out + 1) % c_queue.size;
-
-            /* Decrement the queue size. */
-            c_queue.count--;
-
-            /*************************************************************************
-             *                        End of Critical Section                        *
-             *************************************************************************/
-
-            /* Signal that the queue is no longer full. */
-            pthread_cond_signal(&c_queue.full);
-
-            /* Unlock the queue. */
-            pthread_mutex_unlock(&c_queue.mutex);
-
-            /* Get the sleep time. */
-            if (service_type == 'D') {
-                sleep_time = t_D; /* Set the sleep time to deposit. */
-            } else if (service_type == 'W') {
-                sleep_time = t_W; /* Set the sleep time to withdraw. */
-            } else { /* service_type == 'I' */
-                sleep_time = t_I; /* Set the sleep time to information. */
-            }
-
-            /* Sleep for t_C seconds. */
-            sleep(sleep_time);
-
-            /* Increment the number of customers served. */
-            t.customers_served++;
-
-            /* Get the current time. */
-            get_time(completion_time);
-
-            /* Log the customer served. */
-            sprintf(msg, "Teller: %d\nCustomer: %d\nArrival Time: %s\nCompletion Time: %s\n", t.teller_number, customer_number, current_customer.arrival_time, completion_time);
-            wrt_log(msg);
-        }
-    } while (end_of_file == FALSE || (end_of_file == TRUE && is_empty() == FALSE));
-
-    /* Set the teller end time. */
-    get_time(t.end_time);
-
-    /* Write the teller log exit message. */
-    sprintf(msg, "Termination: teller-%d\n#served customers: %d\nStart time: %s\nTermination time: %s\n", t.teller_number, t.customers_served, t.start_time, t.end_time);
-    wrt_log(msg);
-
-    free(msg); /* Free the memory. */
-
-    tellers[*((int *) arg)] = t; /* Set the teller struct. This is to ensure that the new values are saved. */
-
-    /* Exit the thread. */
-    pthread_exit(NULL);
-    return NULL; /* To avoid warnings. */
-}
-
-/*************************************************************************
- *                            Helper Functions                           *
- *************************************************************************/
-
-/*************************************************************************
- * Log Function.
- *
- * This function writes the log file.
- *
- * @param msg - The message to be written to the log file.
- * @return void
- *************************************************************************/
-void wrt_log(const char *msg) {
-    /* Lock the log file. */
-    pthread_mutex_lock(&log_mutex);
-
-    if (log_file == NULL) {
-        log_file = fopen(LOG_FILE, "w");
-        if (log_file == NULL) {
-            fprintf(stderr, "Error opening log file.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    fprintf(log_file, "%s\n", msg);
-    fflush(log_file); /* Print the message to the log file. */
-
-    pthread_mutex_unlock(&log_mutex);
-}
-
-/*************************************************************************
- * Print Debug Function.
- *
- * This function prints a debug message if the DEBUG flag is set.
- *
- * @param msg - The message to be printed.
- * @return void
- *************************************************************************/
-void debug(const char *msg) {
-
-    /* Lock the debug file. */
-
-    pthread_mutex_lock(&debug_mutex);
-    if (debug_file == NULL) {
-        debug_file = fopen(DEBUG_FILE, "w");
-        if (debug_file == NULL) {
-            fprintf(stderr, "Error opening debug file.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    fprintf(debug_file, "%s\n", msg);
-    fflush(debug_file);
-
-    pthread_mutex_unlock(&debug_mutex);
-}
-
-/*************************************************************************
- * Time Function.
- *
- * This function fills a string with the current time.
- *
- * @param time_str - The pointer to the string to be filled with the current time.
- * @return void
- *************************************************************************/
-void get_time(char *time_str) {
-    time_t tt;
-    struct tm *tm_info;
-
-    tt = time(NULL);
-    tm_info = localtime(&tt);
-    strftime(time_str, 9, "%H:%M:%S", tm_info);
-}
-
-/*************************************************************************
- * Is Empty Function.
- *
- * This function checks if the queue is empty.
- *
- * @return int - TRUE if the queue is empty, FALSE otherwise.
- *************************************************************************/
-int is_empty() {
-    if (c_queue.count == 0) {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-/*************************************************************************
- * Is Full Function.
- *
- * This function checks if the queue is full.
- *
- * @return int - TRUE if the queue is full, FALSE otherwise.
- *************************************************************************/
-int is_full() {
-    if (c_queue.count == c_queue.size) {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-/*************************************************************************
- * Sig Handler Function.
- *
- * This function is called when the program receives a SIGINT signal. It
- * prints the number of customers served by each teller and the total number
- * of customers served.
- * The SIGINT signal is sent when the user presses CTRL+C.
- *
- * @param sig - The signal number.
- * @return void
- *************************************************************************/
-void sig_handler(int signo) {
-    if (signo == SIGINT) {
-        printf("\n");
-        printf("The program was interrupted by the user.\n");
-        exit(0);
-    }
-}
+#include "standard.h"
+#include "sim.h"
+#include "queue.h"
+#include "logger.h"
+#include "ingest.h"
+#include "autoscale.h"
+#include "arrival.h"
+#include "service.h"
+#include "placement.h"
+#include "wheel.h"
+#include "trace.h"
+#include "shm.h"
+#include "live.h"
+#include "sweep.h"
+#include "plan.h"
+#include "router.h"
+#include "admit.h"
+#include "evlog.h"
+
+/*************************************************************************
+ *                            Macro Definitions                          *
+ *************************************************************************/
+
+#define TRUE 1
+#define FALSE 0
+#define T_THREADS 4 /* Default number of teller threads to be created. */
+#define DEBUG_FILE "debug" /* The name of the debug file. */
+#define LOG_FILE "r_log" /* The name of the log file. */
+#define CUSTOMER_FILE "c_file" /* The name of the customer file. */
+
+/*************************************************************************
+ *                            Global Variables                           *
+ *************************************************************************/
+
+FILE *log_file = NULL;
+FILE *debug_file = NULL;
+
+pthread_mutex_t debug_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the debug access. */
+pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the log access. */
+pthread_mutex_t file_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for the file access. */
+
+customer_queue_t local_queue; /* The customer queue, unless it is shared with teller processes. */
+customer_queue_t *c_queue = &local_queue; /* The customer queue, in local_queue or in queue_shm. */
+
+long clock_base_ns; /* The CLOCK_MONOTONIC time matching clock_base_day. */
+long clock_base_day; /* The local wall-clock time of day at clock_base_ns, in seconds. */
+
+int t_I; /* The time duration of an information query. */
+int t_C; /* The customer arrival period. */
+int t_W; /* The time duration of a withdrawal. */
+int t_D; /* The time duration of a deposit. */
+
+teller_t *tellers; /* Array of tellers. */
+
+int n_tellers = T_THREADS; /* Number of teller threads to be created. */
+int n_slots; /* Number of teller slots, the most tellers that can run at once. */
+int n_producers = 1; /* Number of customer threads to be created. */
+long run_start; /* The time the customer threads started, which arrival times count from. */
+double arrival_rate = 0; /* The open-loop arrival rate per second, or 0 to use t_C and the file. */
+int arrival_spacing = ARRIVAL_POISSON; /* The spacing of the open-loop arrivals. */
+service_t service[LAT_TYPES]; /* The service time distributions of 'W', 'D' and 'I'. */
+unsigned long seed = RNG_SEED; /* The seed of the arrival and service time generators. */
+placement_t placement; /* Where the customer and teller threads run. */
+place_stat_t *c_place; /* Where each customer thread ran. */
+place_stat_t *t_place; /* Where each teller slot ran. */
+int no_sleep = FALSE; /* TRUE to skip the t_C and service sleeps, for benchmarking. The -r schedule is still kept. */
+int n_workers = 0; /* The number of event-loop worker threads serving the tellers, or 0 for a thread per teller. */
+int n_groups = 0; /* The number of teller processes, or 0 to run the tellers in this process. */
+shm_t queue_shm; /* The shared memory segment holding the customer queue, with -g. */
+shm_t stats_shm; /* The shared memory segment holding the teller stats, with -g. */
+pid_t *g_pids; /* The teller processes. */
+int n_branches = 1; /* The number of branches, each with its own queue and share of the tellers. */
+int *b_first; /* The first teller slot of each branch, and n_slots after the last. */
+router_t router; /* Routes the customers to the branch queues; queues[0] is c_queue. */
+admit_t admission; /* What happens to the customers when the queue is overloaded. */
+unsigned long balked = 0; /* The number of customers that balked at a deep queue. */
+unsigned long rejected = 0; /* The number of customers the token bucket turned away. */
+
+pthread_t *t_threads; /* Array of teller threads. */
+int *t_running; /* TRUE while the teller thread in a slot has not finished. */
+int *t_joinable; /* TRUE if the teller thread in a slot has been started and not joined. */
+pthread_t a_thread; /* The autoscaling controller thread. */
+int autoscaling = FALSE; /* TRUE if the controller starts and retires tellers. */
+autoscale_t scaler; /* The autoscaling controller. */
+pthread_t *c_threads; /* Array of customer threads. */
+
+int *t_thread_numbers; /* Number of teller threads created (e.g., [ 1, 2, 3, 4 ]). */
+int *c_thread_numbers; /* The shard of the customer file read by each customer thread. */
+long *c_first; /* The customers in the c_file before each shard, counted when an untimed line first needs them. */
+pthread_once_t c_first_once = PTHREAD_ONCE_INIT; /* Counts c_first once for all the customer threads. */
+pthread_t *w_threads; /* Array of event-loop worker threads. */
+int *w_thread_numbers; /* The index of each worker thread. */
+
+/*************************************************************************
+ *                             Main Function                             *
+ *************************************************************************/
+
+/*************************************************************************
+ * Main Function.
+ *
+ * This function is the entry point of the program. It creates the teller and
+ * customer threads and then waits for them to finish.
+ *
+ * @param argc - The number of arguments passed to the program.
+ * @param argv - The arguments passed to the program.
+ *           argv[0] - The file name of the program.
+ *           argv[1] - The size/length of the customer queue (m).
+ *           argv[2] - The customer arrival period (t_C).
+ *           argv[3] - The time duration of a withdrawal (t_W).
+ *           argv[4] - The time duration of a deposit (t_D).
+ *           argv[5] - The time duration of an information query (t_I).
+ *           Options are given before the arguments:
+ *           -s - Run on a virtual clock instead of sleeping.
+ *           -q <type> - The customer queue implementation (mutex, lockfree or steal).
+ *           -t <n> - The number of tellers.
+ *           -p <n> - The number of customer threads, each reading a shard of the file.
+ *           -a <min:max> - Start and retire tellers with the load, between min and max.
+ *           -r <rate>[:poisson|:fixed] - Open-loop arrivals at rate customers per second.
+ *           -d <T:dist> - The service time distribution of service type T.
+ *           -R <seed> - The seed of the arrival and service time generators.
+ *           -P <cpus|node:nodes> - Pin the customer and teller threads to CPUs or NUMA nodes.
+ *           -W <strategy> - How idle tellers wait (condvar, futex or adaptive[:spins[:yields]]).
+ *           -e <n> - Serve the tellers from n event-loop worker threads instead of a thread each.
+ *           -T <file> - Write a Chrome Trace Event JSON timeline of the run to file.
+ *           -g <n> - Run the tellers in n processes, sharing the queue and the stats through shared memory.
+ *           -L <name> - Publish live statistics in the shared memory segment name.
+ *           -M <name> - Print the live statistics another run publishes under name, instead of running.
+ *           -X <file> - Simulate every configuration in file on a pool of threads and print a CSV, instead of running.
+ *           -j <n> - The number of threads for -X and -C (default one per CPU).
+ *           -C <wait|total>:<p>:<ms> - Find the fewest tellers, up to -t, and the smallest queue, up to m, that
+ *                                      keep the p-th percentile below ms on the virtual clock, instead of running.
+ *           -N <n> - The number of seeded runs of each configuration for -C.
+ *           -B <n>[:policy] - Split the tellers into n branches with a queue each, and route the customers
+ *                             between them (random, rr, jsq or p2c).
+ *           -O <behaviour> - What overload does: balk[:depth], renege:<ms> or bucket:<rate>[:<burst>].
+ *           -l <file> - Write the customer and teller events to file as binary records, not to r_log.
+ *           -D [csv:]<file> - Print the events of a binary event log as r_log's text or as CSV.
+ *           -S <policy> - The scheduling policy (fifo, sjf, priority or wfq).
+ *           -w <W:D:I> - The weights of the service types for the policy.
+ *           -n - Do not sleep for t_C or the service times.
+ *           -b - Print the throughput and latency of the run as a CSV line.
+ * @return int - The exit code of the program.
+ *************************************************************************/
+int main(int argc, char *argv[]) {
+    int i; /* Loop counter. */
+    int opt; /* The option returned by getopt(). */
+    int simulated = FALSE; /* TRUE to run on a virtual clock. */
+    int bench = FALSE; /* TRUE to print a CSV line for the benchmark. */
+    int a_min = 0, a_max = 0; /* The bounds of the autoscaler. */
+    int peak; /* The most teller slots that were used. */
+    int status; /* How a teller process ended. */
+    long started; /* The time the threads were started. */
+    int q_type = QUEUE_MUTEX; /* The customer queue implementation. */
+    int policy = POLICY_FIFO; /* The scheduling policy for the waiting customers. */
+    double weight[LAT_TYPES] = {1.0, 1.0, 1.0}; /* The weights of 'W', 'D' and 'I'. */
+    double cost[LAT_TYPES]; /* The expected service times of 'W', 'D' and 'I'. */
+    sim_config_t cfg; /* The configuration of a virtual-time run. */
+    pthread_attr_t attr; /* The attributes of a customer thread. */
+    latency_t *latencies; /* The latencies recorded by each teller, or by each worker with -e. */
+    teller_t *summary; /* The tellers, or with -e one record per worker, for the latency report. */
+    int n_summary; /* The number of records in summary. */
+    const char *label; /* What each record in summary is, "Teller" or "Worker". */
+    service_t dist; /* A service time distribution read from the options. */
+    char service_type; /* The service type the distribution is for. */
+    char *end; /* The end of a number read from the options. */
+    char *field; /* The start of a number read from the options. */
+    const char *place_spec = NULL; /* The CPUs or NUMA nodes to pin the threads to. */
+    const char *trace_path = NULL; /* The trace file, or NULL to not trace. */
+    const char *live_name = NULL; /* The segment to publish the live statistics in, or NULL to not publish. */
+    const char *evlog_path = NULL; /* The binary event log, or NULL to write the events to r_log. */
+    const char *sweep_path = NULL; /* The sweep file, or NULL to run once. */
+    int jobs = 0; /* The number of sweep threads, or 0 for one per CPU. */
+    sweep_t sweep; /* The configurations of a sweep. */
+    plan_target_t target; /* The target of a capacity plan. */
+    int planning = FALSE; /* TRUE to search for the cheapest configuration that meets the target. */
+    int reps = PLAN_REPS; /* The number of seeded runs of each configuration of a plan. */
+    int sweep_v[SWEEP_FIELDS]; /* The largest queue, the time periods and the most tellers of a plan. */
+    int b; /* Branch counter. */
+    unsigned long locks, spun, parks; /* The lock acquisitions, spins and parks of all the branch queues. */
+    unsigned long reneged = 0; /* The customers that reneged from all the branch queues. */
+    wait_t wait = {WAIT_CONDVAR, WAIT_SPINS, WAIT_YIELDS, FALSE}; /* How the tellers and producers wait on the queue. */
+    char *msg = malloc(sizeof(char) * 100);
+
+    /* Match the monotonic clock to the wall clock for the log file. */
+    init_clock();
+
+    /* Initialize the log and debug mutexes. */
+    pthread_mutex_init(&log_mutex, NULL);
+    pthread_mutex_init(&debug_mutex, NULL);
+
+    /* Register the SIGINT signal handler. */
+    if (signal(SIGINT, sig_handler) == SIG_ERR) {
+        printf("Error: Failed to register the SIGINT signal handler.\n");
+    }
+
+    /*************************************************************************
+     * Check the arguments passed to the program.
+     *************************************************************************/
+
+    /* Read the options. */
+    while ((opt = getopt(argc, argv, "sq:t:p:a:r:d:R:P:W:e:T:g:L:M:X:j:C:N:B:O:l:D:S:w:nb")) != -1) {
+        switch (opt) {
+            case 's':
+                simulated = TRUE;
+                break;
+            case 'q':
+                q_type = queue_type(optarg);
+                if (q_type < 0) {
+                    printf("Error: Unknown queue type: %s\n", optarg);
+                    usage(argv[0]);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 't':
+                n_tellers = atoi(optarg);
+                if (n_tellers < 1) {
+                    printf("Error: The number of tellers must be greater than 0.\n");
+                    printf("Entered number of tellers: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'p':
+                n_producers = atoi(optarg);
+                if (n_producers < 1) {
+                    printf("Error: The number of customer threads must be greater than 0.\n");
+                    printf("Entered number of customer threads: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'a':
+                a_min = (int) strtol(optarg, &end, 10);
+                a_max = end != optarg && *end == ':' ? (int) strtol(end + 1, &end, 10) : 0;
+                if (*end != '\0' || a_min < 1 || a_max < a_min) {
+                    printf("Error: The autoscaling bounds must be min:max, with 1 <= min <= max.\n");
+                    printf("Entered bounds: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                autoscaling = TRUE;
+                break;
+            case 'r':
+                if (arrival_parse(optarg, &arrival_rate, &arrival_spacing) != 0) {
+                    printf("Error: The arrival rate must be a number greater than 0, optionally followed by\n");
+                    printf("       :poisson or :fixed.\n");
+                    printf("Entered arrival rate: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'd':
+                if (service_parse(optarg, &service_type, &dist) != 0) {
+                    printf("Error: The service time distribution must be T:fixed, T:exp, T:lognormal[:sigma] or\n");
+                    printf("       T:empirical:<file>, where T is W, D or I.\n");
+                    printf("Entered distribution: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                service[latency_type(service_type)] = dist;
+                break;
+            case 'R':
+                seed = strtoul(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    printf("Error: The seed must be a whole number.\n");
+                    printf("Entered seed: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'P':
+                place_spec = optarg;
+                break;
+            case 'W':
+                if (wait_parse(optarg, &wait) != 0) {
+                    printf("Error: The wait strategy must be condvar, futex or adaptive[:spins[:yields]].\n");
+                    printf("Entered wait strategy: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'e':
+                n_workers = atoi(optarg);
+                if (n_workers < 1) {
+                    printf("Error: The number of worker threads must be greater than 0.\n");
+                    printf("Entered number of worker threads: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'T':
+                trace_path = optarg;
+                break;
+            case 'L':
+                live_name = optarg;
+                break;
+            case 'M':
+                /* Watch another run instead of running. */
+                return live_watch(optarg);
+            case 'X':
+                sweep_path = optarg;
+                break;
+            case 'j':
+                jobs = atoi(optarg);
+                if (jobs < 1) {
+                    printf("Error: The number of sweep threads must be greater than 0.\n");
+                    printf("Entered number of sweep threads: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'C':
+                if (plan_parse(optarg, &target) != 0) {
+                    printf("Error: The target must be <wait|total>:<percentile>:<ms>, e.g. wait:99:500.\n");
+                    printf("Entered target: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                planning = TRUE;
+                break;
+            case 'N':
+                reps = atoi(optarg);
+                if (reps < 1) {
+                    printf("Error: The number of runs per configuration must be greater than 0.\n");
+                    printf("Entered number of runs: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'g':
+                n_groups = atoi(optarg);
+                if (n_groups < 1) {
+                    printf("Error: The number of teller processes must be greater than 0.\n");
+                    printf("Entered number of teller processes: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'B':
+                router.policy = ROUTE_P2C;
+                n_branches = (int) strtol(optarg, &end, 10);
+                if (end == optarg || n_branches < 1
+                    || (*end != '\0' && (*end != ':' || (router.policy = route_policy(end + 1)) < 0))) {
+                    printf("Error: The branches must be given as <n>[:random|rr|jsq|p2c], with n greater than 0.\n");
+                    printf("Entered branches: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'O':
+                if (admit_parse(optarg, &admission) != 0) {
+                    printf("Error: The overload behaviour must be balk[:depth], renege:<ms> or bucket:<rate>[:<burst>],\n");
+                    printf("       with every number greater than 0.\n");
+                    printf("Entered overload behaviour: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'l':
+                evlog_path = optarg;
+                break;
+            case 'D':
+                /* Decode an event log, and do nothing else. */
+                if (strncmp(optarg, "csv:", 4) == 0) {
+                    opt = evlog_decode(optarg + 4, TRUE);
+                } else {
+                    opt = evlog_decode(strncmp(optarg, "text:", 5) == 0 ? optarg + 5 : optarg, FALSE);
+                }
+                free(msg);
+                return opt;
+            case 'n':
+                no_sleep = TRUE;
+                break;
+            case 'b':
+                bench = TRUE;
+                break;
+            case 'S':
+                policy = sched_policy(optarg);
+                if (policy < 0) {
+                    printf("Error: Unknown scheduling policy: %s\n", optarg);
+                    usage(argv[0]);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            case 'w':
+                for (i = 0, end = optarg; i < LAT_TYPES; i++) {
+                    field = i == 0 ? end : end + 1;
+                    weight[i] = strtod(field, &end);
+                    if (end == field || weight[i] <= 0 || *end != (i < LAT_TYPES - 1 ? ':' : '\0')) {
+                        break;
+                    }
+                }
+                if (i < LAT_TYPES) {
+                    printf("Error: The weights must be three numbers greater than 0, as W:D:I.\n");
+                    printf("Entered weights: %s\n", optarg);
+                    return 1; /* Exit with error code 1. */
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1; /* Exit with error code 1. */
+        }
+    }
+
+    /*************************************************************************
+     * Sweep the configurations of a file on the virtual clock.
+     *************************************************************************/
+
+    if (sweep_path != NULL) {
+        if (argc - optind != 0 || autoscaling == TRUE || n_workers > 0 || n_groups > 0 || trace_path != NULL
+            || live_name != NULL || n_branches > 1 || overloaded()) {
+            printf("Error: -X takes its configurations from the file, and cannot be used with -a, -e, -g, -T, -L, -B or -O.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        if (sweep_parse(&sweep, sweep_path, n_tellers) != 0) {
+            return 1; /* Exit with error code 1. */
+        }
+        memset(&sweep.base, 0, sizeof(sim_config_t));
+        sweep.base.customer_file = CUSTOMER_FILE;
+        sweep.base.policy = policy;
+        sweep.base.rate = arrival_rate;
+        sweep.base.spacing = arrival_spacing;
+        sweep.base.seed = seed;
+        for (i = 0; i < LAT_TYPES; i++) {
+            sweep.base.weight[i] = weight[i];
+            sweep.base.service[i] = service[i];
+        }
+        opt = sweep_run(&sweep, jobs);
+        sweep_print(&sweep, stdout);
+        sweep_destroy(&sweep);
+        free(msg);
+        return opt; /* Exit with error code 1 if a configuration failed. */
+    }
+
+    /* Check if the correct number of arguments were passed. */
+    if (argc - optind != 5) {
+        usage(argv[0]);
+        return 1; /* Exit with error code 1. */
+    } else {
+        sprintf(msg, "The number of arguments passed: %d", argc);
+        sprintf(msg, "The arguments passed to the program:");
+        for (i = 0; i < argc; i++) {
+            sprintf(msg, "  argv[%d] = %s", i, argv[i]);
+        }
+    }
+
+    /* Get the queue size. */
+    c_queue->size = atoi(argv[optind]);
+
+    /* Get the time periods. */
+    t_C = atoi(argv[optind + 1]);
+    t_W = atoi(argv[optind + 2]);
+    t_D = atoi(argv[optind + 3]);
+    t_I = atoi(argv[optind + 4]);
+
+    /* Check that the queue size is greater than 0. */
+    if (c_queue->size <= 0) {
+        printf("Error: The queue size must be greater than 0.\n");
+        printf("Entered queue size: %d\n", c_queue->size);
+        printf("Usage: %s <m> <t_C> <t_W> <t_D> <t_I>\n", argv[0]);
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* Check that the time periods are all greater or equal to 1 */
+    if (t_C < 1 || t_W < 1 || t_D < 1 || t_I < 1) {
+        printf("Error: All time periods must be greater than or equal to 1.\n");
+        printf("Entered time periods: t_C=%d, t_W=%d, t_D=%d, t_I=%d\n", t_C, t_W, t_D, t_I);
+        printf("Usage: %s <m> <t_C> <t_W> <t_D> <t_I>\n", argv[0]);
+        return 1; /* Exit with error code 1. */
+    }
+
+    /*************************************************************************
+     * Search for the cheapest configuration that meets the target.
+     *************************************************************************/
+
+    if (planning == TRUE) {
+        if (autoscaling == TRUE || n_workers > 0 || n_groups > 0 || trace_path != NULL || live_name != NULL
+            || n_branches > 1 || overloaded()) {
+            printf("Error: -C runs on the virtual clock, and cannot be used with -a, -e, -g, -T, -L, -B or -O.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        memset(&cfg, 0, sizeof(sim_config_t));
+        cfg.customer_file = CUSTOMER_FILE;
+        cfg.policy = policy;
+        cfg.rate = arrival_rate;
+        cfg.spacing = arrival_spacing;
+        cfg.seed = seed;
+        for (i = 0; i < LAT_TYPES; i++) {
+            cfg.weight[i] = weight[i];
+            cfg.service[i] = service[i];
+        }
+        sweep_v[0] = c_queue->size;
+        sweep_v[1] = t_C;
+        sweep_v[2] = t_W;
+        sweep_v[3] = t_D;
+        sweep_v[4] = t_I;
+        sweep_v[5] = n_tellers;
+        opt = plan_run(&cfg, &target, sweep_v, reps, jobs);
+        free(msg);
+        return opt; /* Exit with error code 1 if no configuration meets the target. */
+    }
+
+    /* Open the debug and log file. A sweep or a plan writes neither. */
+    debug_file = fopen(DEBUG_FILE, "w");
+    log_file = fopen(LOG_FILE, "w");
+
+    /* Scale the service time distributions to t_W, t_D and t_I. */
+    if (service_init(&service[0], t_W) != 0 || service_init(&service[1], t_D) != 0
+        || service_init(&service[2], t_I) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* The autoscaler starts with the -t tellers, kept within its bounds. */
+    n_slots = n_tellers;
+    if (autoscaling == TRUE) {
+        if (simulated == TRUE) {
+            printf("Error: Autoscaling needs the threaded mode, not -s.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        n_tellers = n_tellers < a_min ? a_min : (n_tellers > a_max ? a_max : n_tellers);
+        n_slots = a_max;
+        if (autoscale_init(&scaler, a_min, a_max) != 0) {
+            return 1; /* Exit with error code 1. */
+        }
+    }
+
+    if (trace_path != NULL && simulated == TRUE) {
+        printf("Error: Tracing needs the threaded mode, not -s.\n");
+        return 1; /* Exit with error code 1. */
+    }
+    if (live_name != NULL && simulated == TRUE) {
+        printf("Error: Live statistics need the threaded mode, not -s.\n");
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* The workers each serve at least one teller. */
+    if (n_workers > 0) {
+        if (simulated == TRUE || autoscaling == TRUE) {
+            printf("Error: The event-loop engine needs the threaded mode with a fixed number of tellers, not -s or -a.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        n_workers = n_workers < n_tellers ? n_workers : n_tellers;
+    }
+
+    /* Each teller process runs at least one teller, and they share the lock-free ring. */
+    if (n_groups > 0) {
+        if (simulated == TRUE || autoscaling == TRUE || n_workers > 0 || trace_path != NULL) {
+            printf("Error: Teller processes cannot be used with -s, -a, -e or -T.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        n_groups = n_groups < n_tellers ? n_groups : n_tellers;
+        q_type = QUEUE_LOCKFREE;
+    }
+
+    /* Each branch has at least one teller, and a fixed share of them. */
+    if (n_branches > 1) {
+        if (simulated == TRUE || autoscaling == TRUE || n_workers > 0 || n_groups > 0) {
+            printf("Error: Branches need the threaded mode with a thread per teller, not -s, -a, -e or -g.\n");
+            return 1; /* Exit with error code 1. */
+        }
+        n_branches = n_branches < n_tellers ? n_branches : n_tellers;
+    }
+    b_first = malloc(sizeof(int) * (n_branches + 1));
+
+    /* Overload control acts on the real queue, so the virtual clock has none. Balking is capped at the queue size. */
+    if (overloaded() && simulated == TRUE) {
+        printf("Error: -O needs the threaded mode, not -s.\n");
+        return 1; /* Exit with error code 1. */
+    }
+    /* Only the mutex queue in arrival order can free the slot of a customer that is still waiting. */
+    if (admission.patience > 0 && (q_type != QUEUE_MUTEX || policy != POLICY_FIFO)) {
+        printf("Error: -O renege needs the mutex queue in fifo order, not -q lockfree, -q steal, -g or -S.\n");
+        return 1; /* Exit with error code 1. */
+    }
+    if (admission.balk == ADMIT_FULL || admission.balk > local_queue.size) {
+        admission.balk = local_queue.size;
+    }
+    for (b = 0; b <= n_branches; b++) {
+        b_first[b] = b * n_slots / n_branches;
+    }
+
+    /* Move to the home node, so the queue and the tellers are allocated there. */
+    if (place_init(&placement, place_spec) != 0 || place_home(&placement) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* Start the logger thread. From here on the log file is written in batches. */
+    if (logger_start(log_file) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* With -l the events go to the binary event log, and r_log keeps the statistics. */
+    if (evlog_path != NULL && evlog_open(evlog_path, clock_base_ns, clock_base_day) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+
+    /*************************************************************************
+     * Run on the virtual clock.
+     *************************************************************************/
+
+    if (simulated == TRUE) {
+        cfg.queue_size = c_queue->size;
+        cfg.tellers = n_tellers;
+        cfg.t_C = t_C;
+        cfg.customer_file = CUSTOMER_FILE;
+        cfg.log = TRUE;
+        cfg.policy = policy;
+        cfg.rate = arrival_rate;
+        cfg.spacing = arrival_spacing;
+        cfg.seed = seed;
+        for (i = 0; i < LAT_TYPES; i++) {
+            cfg.weight[i] = weight[i];
+            cfg.service[i] = service[i];
+        }
+
+        tellers = malloc(sizeof(struct teller) * n_tellers);
+        latencies = calloc(n_tellers, sizeof(latency_t));
+        for (i = 0; i < n_tellers; i++) {
+            tellers[i].latency = &latencies[i];
+        }
+        started = now_ns();
+        if (simulate(&cfg, tellers) != 0) {
+            return 1; /* Exit with error code 1. */
+        }
+        if (bench == TRUE) {
+            print_bench(tellers, n_tellers, now_ns() - started, 0);
+        }
+        evlog_close();
+        log_statistics(tellers, n_tellers);
+        log_latency(tellers, n_tellers, "Teller");
+        logger_stop();
+
+        free(tellers);
+        free(latencies);
+        for (i = 0; i < LAT_TYPES; i++) {
+            service_destroy(&service[i]);
+        }
+        free(msg);
+        fclose(log_file);
+        fclose(debug_file);
+        return 0;
+    }
+
+    /*************************************************************************
+     * Initialize the customer queue.
+     *************************************************************************/
+
+    /* With -g the queue and its slots are in a segment shared with the teller processes. */
+    if (n_groups > 0) {
+        if (shm_create(&queue_shm, "queue", sizeof(customer_queue_t) + ring_bytes(local_queue.size, sizeof(customer_t))
+                                            + 2 * CACHE_LINE) != 0) {
+            return 1; /* Exit with error code 1. */
+        }
+        c_queue = shm_alloc(&queue_shm, sizeof(customer_queue_t));
+        if (queue_init_shared(c_queue, q_type, local_queue.size, n_slots, n_producers, &queue_shm) != 0) {
+            return 1; /* Exit with error code 1. */
+        }
+
+    /* With -B each branch has a queue of m, whose tellers are the branch's. */
+    } else if (n_branches > 1) {
+        c_queue = calloc(n_branches, sizeof(customer_queue_t));
+        for (b = 0; b < n_branches; b++) {
+            if (c_queue == NULL
+                || queue_init(&c_queue[b], q_type, local_queue.size, b_first[b + 1] - b_first[b], n_producers) != 0) {
+                return 1; /* Exit with error code 1. */
+            }
+            queue_scale(&c_queue[b], b_first[b + 1] - b_first[b]);
+        }
+
+    /* With -e the workers take the customers, so each worker is one of the queue's tellers. */
+    } else if (queue_init(c_queue, q_type, c_queue->size, n_workers > 0 ? n_workers : n_slots, n_producers) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+    if (n_branches == 1) {
+        queue_scale(c_queue, n_workers > 0 ? n_workers : n_tellers);
+    }
+    router.branches = n_branches;
+    router.queues = c_queue;
+    for (b = 0; b < n_branches; b++) {
+        queue_wait(&router.queues[b], &wait);
+        queue_patience(&router.queues[b], admission.patience);
+    }
+
+    /* Order the waiting customers by service type, if a policy was chosen. */
+    if (policy != POLICY_FIFO) {
+        for (i = 0; i < LAT_TYPES; i++) {
+            cost[i] = service[i].mean / 1e9;
+        }
+        for (b = 0; b < n_branches; b++) {
+            if (queue_schedule(&router.queues[b], policy, cost, weight) != 0) {
+                return 1; /* Exit with error code 1. */
+            }
+        }
+    }
+
+    /*************************************************************************
+     * Initialize the mutexes.
+     *************************************************************************/
+
+    if (pthread_mutex_init(&file_mutex, NULL) != 0) {
+        printf("Error: Failed to initialize the teller mutex.\n");
+        return 1; /* Exit with error code 1. */
+    }
+
+    /* Create the teller threads, or the workers that serve them. The slots above n_tellers are only used by the autoscaler. */
+    started = now_ns();
+    if (trace_path != NULL && trace_open(trace_path, started) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+    if (live_name != NULL && live_open(live_name, n_workers > 0 ? n_tellers : n_slots, c_queue->size, started) != 0) {
+        return 1; /* Exit with error code 1. */
+    }
+    if (n_workers > 0) {
+        tellers = calloc(n_tellers, sizeof(struct teller));
+        latencies = calloc(n_workers, sizeof(latency_t));
+        t_place = calloc(n_workers, sizeof(place_stat_t));
+        w_threads = malloc(sizeof(pthread_t) * n_workers);
+        w_thread_numbers = malloc(sizeof(int) * n_workers);
+        for (i = 0; i < n_tellers; i++) {
+            tellers[i].teller_number = i + 1;
+            tellers[i].start_time = now_ns();
+            tellers[i].latency = &latencies[i % n_workers];
+            live_teller(i, tellers[i].teller_number, tellers[i].start_time);
+        }
+        for (i = 0; i < n_workers; i++) {
+            w_thread_numbers[i] = i;
+
+            /* The workers take the places after the customer threads, as the teller threads do. */
+            if (place_attr(&placement, &attr, n_producers + i) != 0
+                || pthread_create(&w_threads[i], &attr, worker, (void *) &w_thread_numbers[i]) != 0) {
+                printf("Error: Failed to create worker thread %d.\n", i + 1);
+                exit(1);
+            }
+            pthread_attr_destroy(&attr);
+        }
+    } else {
+        if (n_groups > 0) {
+            /* The teller stats are written by the teller processes and read here once they have exited. */
+            if (shm_create(&stats_shm, "stats", (sizeof(struct teller) + sizeof(latency_t) + sizeof(place_stat_t)) * n_slots
+                                                + 3 * CACHE_LINE) != 0) {
+                return 1; /* Exit with error code 1. */
+            }
+            tellers = shm_alloc(&stats_shm, sizeof(struct teller) * n_slots);
+            latencies = shm_alloc(&stats_shm, sizeof(latency_t) * n_slots);
+            t_place = shm_alloc(&stats_shm, sizeof(place_stat_t) * n_slots);
+        } else {
+            tellers = calloc(n_slots, sizeof(struct teller));
+            latencies = calloc(n_slots, sizeof(latency_t));
+            t_place = calloc(n_slots, sizeof(place_stat_t));
+        }
+        t_threads = malloc(sizeof(pthread_t) * n_slots);
+        t_thread_numbers = malloc(sizeof(int) * n_slots);
+        t_running = calloc(n_slots, sizeof(int));
+        t_joinable = calloc(n_slots, sizeof(int));
+        for (i = 0; i < n_slots; i++) {
+            /* Set the teller thread numbers. */
+            t_thread_numbers[i] = i;
+            tellers[i].latency = &latencies[i];
+        }
+        g_pids = malloc(sizeof(pid_t) * (n_groups > 0 ? n_groups : 1));
+        for (i = 0; i < n_groups; i++) {
+            start_group(i);
+        }
+        for (i = 0; i < n_tellers && n_groups == 0; i++) {
+            start_teller(i);
+            sprintf(msg, "Created teller thread %d.", i + 1);
+        }
+    }
+
+    /* Create the controller thread, which starts and retires tellers with the load. */
+    if (autoscaling == TRUE && pthread_create(&a_thread, NULL, controller, NULL) != 0) {
+        printf("Error: Failed to create the autoscaling controller thread.\n");
+        exit(1);
+    }
+
+    /* Create the customer threads, each reading its own shard of the customer file. */
+    c_threads = malloc(sizeof(pthread_t) * n_producers);
+    c_thread_numbers = malloc(sizeof(int) * n_producers);
+    c_place = calloc(n_producers, sizeof(place_stat_t));
+    run_start = now_ns();
+    for (i = 0; i < n_producers; i++) {
+        c_thread_numbers[i] = i;
+
+        /* The below line is initializing the customer thread with the customer function.
+         * pthread_create(<address of thread>, <thread attributes>, <customer function to run>, <shard>)
+         * The customer threads take the first places.
+         */
+        if (place_attr(&placement, &attr, i) != 0
+            || pthread_create(&c_threads[i], &attr, customer, (void *) &c_thread_numbers[i]) != 0) {
+            printf("Error: Failed to create customer thread %d.\n", i + 1);
+            exit(1);
+        }
+        pthread_attr_destroy(&attr);
+
+        sprintf(msg, "Created customer thread %d.", i + 1);
+    }
+
+    /* Wait for the customer threads to finish. */
+    for (i = 0; i < n_producers; i++) {
+        pthread_join(c_threads[i], NULL);
+        sprintf(msg, "Joined customer thread %d.", i + 1);
+    }
+
+    /* The controller stops once the end of the file has been reached, and starts no more tellers. */
+    if (autoscaling == TRUE) {
+        pthread_join(a_thread, NULL);
+    }
+
+    /* Wait for the teller processes, and log any that did not exit cleanly. */
+    for (i = 0; i < n_groups; i++) {
+        if (waitpid(g_pids[i], &status, 0) == g_pids[i] && (WIFSIGNALED(status) || WEXITSTATUS(status) != 0)) {
+            sprintf(msg, "Error: Teller process %d ended with %s %d.", i + 1,
+                    WIFSIGNALED(status) ? "signal" : "exit code", WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+            printf("%s\n", msg);
+            wrt_log(msg);
+        }
+    }
+
+    /* Wait for the teller threads, or the workers, to finish. */
+    peak = 0;
+    for (i = 0; i < n_workers; i++) {
+        pthread_join(w_threads[i], NULL);
+        peak = n_tellers;
+    }
+    for (i = 0; i < n_slots && n_workers == 0; i++) {
+        if (t_joinable[i] == TRUE) {
+            pthread_join(t_threads[i], NULL);
+            sprintf(msg, "Joined teller thread %d.", i + 1);
+        }
+        if (tellers[i].teller_number != 0) {
+            peak = i + 1; /* The slots are used from the first one up. */
+        }
+    }
+
+    /* Every traced thread has written out its events, the live statistics are final and the event log is complete. */
+    trace_close();
+    live_close();
+    evlog_close();
+
+    /* A worker records the latencies of all its tellers, so the latency report has a line per worker. */
+    summary = tellers;
+    n_summary = peak;
+    label = "Teller";
+    if (n_workers > 0) {
+        summary = calloc(n_workers, sizeof(struct teller));
+        n_summary = n_workers;
+        label = "Worker";
+        for (i = 0; i < n_workers; i++) {
+            summary[i].teller_number = i + 1;
+            summary[i].latency = &latencies[i];
+        }
+        for (i = 0; i < n_tellers; i++) {
+            summary[i % n_workers].customers_served += tellers[i].customers_served;
+        }
+    }
+
+    /* Add up the branch queues. */
+    locks = 0;
+    spun = 0;
+    parks = 0;
+    for (b = 0; b < n_branches; b++) {
+        locks += queue_locks(&router.queues[b]);
+        spun += router.queues[b].spun;
+        parks += router.queues[b].parks;
+    }
+
+    /* Print the teller stats, then write everything still waiting in the log ring. */
+    if (bench == TRUE) {
+        print_bench(summary, n_summary, now_ns() - started, locks);
+    }
+    log_statistics(tellers, peak);
+    if (overloaded()) {
+        for (b = 0; b < n_branches; b++) {
+            reneged += router.queues[b].reneged;
+        }
+        log_overload(reneged);
+    }
+    log_locks(locks, tellers, peak);
+    log_waits(&wait, spun, parks);
+    log_placement(n_workers > 0 ? n_workers : peak, label);
+    log_latency(summary, n_summary, label);
+    if (n_branches > 1) {
+        log_branches(tellers, n_slots);
+    }
+    logger_stop();
+    if (summary != tellers) {
+        free(summary);
+    }
+
+    /*************************************************************************
+     * Print the results.
+     *************************************************************************/
+
+    if (n_groups == 0) {
+        free(tellers);
+        free(latencies);
+        free(t_place);
+    }
+    for (i = 0; i < LAT_TYPES; i++) {
+        service_destroy(&service[i]);
+    }
+    free(t_threads);
+    free(t_thread_numbers);
+    free(t_running);
+    free(t_joinable);
+    if (autoscaling == TRUE) {
+        autoscale_destroy(&scaler);
+    }
+    free(w_threads);
+    free(w_thread_numbers);
+    free(c_threads);
+    free(c_thread_numbers);
+    free(c_first);
+    free(c_place);
+    free(g_pids);
+    place_destroy(&placement);
+
+    /* Free the memory. */
+    free(msg); /* Free the message string. */
+
+    /* Free the queues, their mutexes and their condition variables, then the shared segments if there are any. */
+    for (b = 0; b < n_branches; b++) {
+        queue_destroy(&router.queues[b]);
+    }
+    if (n_branches > 1) {
+        free(router.queues);
+    }
+    free(b_first);
+    shm_destroy(&queue_shm);
+    shm_destroy(&stats_shm);
+
+    /* Close the files. */
+    fclose(log_file);
+    fclose(debug_file);
+
+    return 0;
+}
+
+/*************************************************************************
+ *                           Thread Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Count Shards Function.
+ *
+ * This function fills c_first with one pass over the c_file, for the
+ * first customer thread that reads a line without an arrival time. The
+ * others wait for it in pthread_once(), then share the counts.
+ *
+ * @return void
+ *************************************************************************/
+static void count_shards(void) {
+    c_first = malloc(sizeof(long) * n_producers);
+    if (c_first == NULL || ingest_count(CUSTOMER_FILE, n_producers, c_first) != 0) {
+        printf("Error counting the customers in %s.\n", CUSTOMER_FILE);
+        exit(1);
+    }
+}
+
+/*************************************************************************
+ * Next Customer Function.
+ *
+ * This function reads the next customer of a shard and finds its arrival
+ * time, from the open-loop schedule with -r or from its line of the file.
+ * A line without an arrival time arrives t_C seconds after the customer
+ * before it in the whole file, so the shards share one t_C schedule, as
+ * they share the -r one. The shards after the first need the number of
+ * customers before them for that, which count_shards() finds the first
+ * time it is needed. With -n and no -r the arrival times are ignored.
+ *
+ * @param in - The customer file reader.
+ * @param schedule - The open-loop arrival schedule, used with -r.
+ * @param c - The customer to be filled in.
+ * @param at - Set to the arrival time in ns from run_start, or -1 to not wait.
+ * @param paced - Set to TRUE if the arrival time came from t_C.
+ * @return int - TRUE if a customer was read, FALSE at the end of the shard.
+ *************************************************************************/
+static int next_customer(ingest_t *in, arrival_t *schedule, customer_t *c, long *at, int *paced) {
+    if (ingest_next(in, c, at) == FALSE) {
+        return FALSE;
+    }
+    *paced = FALSE;
+    if (arrival_rate > 0) {
+        *at = arrival_next(schedule);
+    } else if (no_sleep == TRUE) {
+        *at = -1;
+    } else if (*at < 0) {
+        if (in->shard > 0) {
+            pthread_once(&c_first_once, count_shards);
+        }
+        *at = ((in->shard > 0 ? c_first[in->shard] : 0) + in->index) * t_C * 1000000000L;
+        *paced = TRUE;
+    }
+    return TRUE;
+}
+
+/*************************************************************************
+ * Branch Of Function.
+ *
+ * @param slot - The teller slot.
+ * @return int - The branch the teller serves.
+ *************************************************************************/
+static int branch_of(int slot) {
+    int b = slot * n_branches / n_slots;
+
+    while (b_first[b + 1] <= slot) {
+        b++;
+    }
+    while (b_first[b] > slot) {
+        b--;
+    }
+    return b;
+}
+
+/*************************************************************************
+ * Queued Function.
+ *
+ * @return int - The number of customers waiting in all the branch queues.
+ *************************************************************************/
+static int queued(void) {
+    int n = 0;
+    int b; /* Branch counter. */
+
+    for (b = 0; b < n_branches; b++) {
+        n += queue_count(&router.queues[b]);
+    }
+    return n;
+}
+
+/*************************************************************************
+ * Overloaded Function.
+ *
+ * @return int - TRUE if any overload behaviour was set with -O.
+ *************************************************************************/
+int overloaded(void) {
+    return admission.balk != 0 || admission.patience > 0 || admission.rate > 0;
+}
+
+/*************************************************************************
+ * Admit Function.
+ *
+ * This function decides whether an arriving customer joins its queue:
+ * it balks if the queue is at the balking depth, and is rejected if the
+ * producer's token bucket is empty. A customer turned away is logged and
+ * counted, and never waits.
+ *
+ * @param c - The arriving customer.
+ * @param depth - The customers already in or joining the customer's queue.
+ * @param bucket - The producer's token bucket.
+ * @param now - The current time, in ns.
+ * @return int - TRUE if the customer joins the queue, FALSE otherwise.
+ *************************************************************************/
+static int admit(customer_t *c, int depth, bucket_t *bucket, long now) {
+    if (admission.balk > 0 && depth >= admission.balk) {
+        c->arrival_time = now;
+        log_departure(c, "Balked", now);
+        __atomic_add_fetch(&balked, 1, __ATOMIC_RELAXED);
+        return FALSE;
+    }
+    if (admission.rate > 0 && bucket_take(bucket, now) == 0) {
+        c->arrival_time = now;
+        log_departure(c, "Rejected", now);
+        __atomic_add_fetch(&rejected, 1, __ATOMIC_RELAXED);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*************************************************************************
+ * Customer Producer Function.
+ *
+ * This function reads its shard of the c_file and creates the customers
+ * based on the data in the file. It then adds the customers to the
+ * shared queue. A customer arrives t_C seconds after the one before it
+ * in the file, at the arrival time given on its line of the file, or,
+ * with -r, at the next time of the open-loop arrival schedule. Every
+ * customer thread counts arrival times from run_start, so the shards are
+ * merged by arrival time in the queue. A customer that is added late,
+ * because the queue was full or the thread fell behind, keeps the time
+ * it was meant to arrive as its intended_time. With -B each customer
+ * is routed to a branch queue on its own. With -O a customer may be
+ * turned away instead of waiting for room (see admit()).
+ *
+ * @param arg - The index of the shard to be read.
+ * @return void* - The return value of the thread.
+ *************************************************************************/
+void *customer(void *arg) {
+    ingest_t in; /* The customer file reader. */
+    int paced = FALSE; /* TRUE if the last customer read arrives on the t_C schedule. */
+    arrival_t schedule; /* The open-loop arrival schedule, with -r. */
+    place_stat_t place; /* Where this thread ran. */
+    customer_t batch[QUEUE_BATCH + 1]; /* The customers arriving together, and the next one. */
+    rng_t rng; /* The generator for the routing of this shard. */
+    unsigned long turn = 0; /* The round-robin position of this shard. */
+    bucket_t bucket; /* The admission token bucket of this shard. */
+    long now; /* The time the batch arrived. */
+    int depth; /* The customers in the queue when the batch arrived. */
+    int admitted; /* The number of customers in the batch that join a queue. */
+    int b; /* The branch a customer is routed to. */
+    long at = -1; /* The arrival time of the customer, or -1 to use t_C. */
+    long next_at; /* The arrival time of the customer after the batch. */
+    int more; /* TRUE while there are customers left in the file. */
+    int n; /* The number of customers in the batch. */
+    int i; /* Loop counter. */
+
+    if (ingest_open(&in, CUSTOMER_FILE) != 0) {
+        printf("Error opening file.\n");
+        exit(1);
+    }
+    ingest_shard(&in, *((int *) arg), n_producers);
+    place = c_place[*((int *) arg)];
+    trace_attach();
+    if (arrival_rate > 0) {
+        arrival_init(&schedule, arrival_spacing, arrival_rate, *((int *) arg), n_producers, seed);
+    }
+    rng_seed(&rng, seed + RNG_ROUTE_STREAM + *((int *) arg));
+    if (admission.rate > 0) {
+        bucket_init(&bucket, &admission, n_producers, now_ns());
+    }
+
+    more = next_customer(&in, &schedule, &batch[0], &at, &paced);
+    while (more == TRUE) {
+        /* Sleep until the customer arrives. */
+        if (at >= 0) {
+            sleep_until(run_start + at);
+        }
+        batch[0].intended_time = at >= 0 ? run_start + at : now_ns();
+
+        /* The customers whose arrival time has already passed join the batch. */
+        n = 1;
+        while ((more = next_customer(&in, &schedule, &batch[n], &next_at, &paced)) == TRUE && n < QUEUE_BATCH
+               && (next_at >= 0 ? run_start + next_at <= now_ns() : no_sleep == TRUE)) {
+            batch[n].intended_time = next_at >= 0 ? run_start + next_at : batch[0].intended_time;
+            n++;
+        }
+
+        /* Add the customers to the queue, as many at a time as there is room for, or route each to a branch. */
+        place_sample(&placement, &place);
+        now = overloaded() ? now_ns() : 0;
+        admitted = 0;
+        if (n_branches == 1) {
+            depth = admission.balk > 0 ? queue_count(c_queue) : 0;
+            for (i = 0; i < n; i++) {
+                if (admit(&batch[i], depth + admitted, &bucket, now) == TRUE) {
+                    batch[admitted++] = batch[i];
+                }
+            }
+            for (i = 0; i < admitted; ) {
+                i += queue_put_batch(c_queue, &batch[i], admitted - i);
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                b = route_pick(&router, &rng, &turn);
+                if (admit(&batch[i], queue_count(&router.queues[b]), &bucket, now) == TRUE) {
+                    queue_put_batch(&router.queues[b], &batch[i], 1);
+                    admitted++;
+                }
+            }
+        }
+        trace_counter(TRACE_QUEUE, queued());
+        live_arrivals(admitted, queued());
+
+        /* The customer read after the batch starts the next one. */
+        if (more == TRUE) {
+            batch[0] = batch[n];
+            at = next_at;
+        }
+    }
+
+    /* Without arrival times, the end of the file is only seen one period after the last customer. */
+    if (paced == TRUE) {
+        sleep_until(run_start + ((in.shard > 0 ? c_first[in.shard] : 0) + in.index + 1) * t_C * 1000000000L);
+    }
+
+    /* The end of the file has been reached. */
+    for (i = 0; i < n_branches; i++) {
+        queue_close(&router.queues[i]);
+    }
+    ingest_close(&in);
+    c_place[*((int *) arg)] = place;
+    trace_detach();
+
+    /* Exit the thread. */
+    pthread_exit(NULL);
+    return NULL; /* This line is only here to prevent a warning. */
+}
+
+/*************************************************************************
+ * Teller Consumer Function.
+ *
+ * This function is the entry point of the teller threads. It simulates
+ * the teller serving customers. It is the consumer thread. With -B it
+ * serves only its branch's queue.
+ *
+ * @param arg - The teller struct.
+ * @return void* - The teller struct.
+ *************************************************************************/
+void *teller(void *arg) {
+    long response_time; /* The time the teller took the customer. */
+    long completion_time; /* The time the teller finished with the customer. */
+    long service_time; /* The time the teller takes to serve the customer, in ns. */
+    rng_t rng; /* The generator for the service times of this teller. */
+    place_stat_t place; /* Where this teller ran. */
+    customer_t batch[QUEUE_BATCH]; /* The customers claimed from the queue. */
+    customer_t current_customer;
+    char service_type;
+    customer_queue_t *q; /* The queue of the teller's branch. */
+    int b; /* The teller's branch. */
+    int max; /* The most customers to claim at once. */
+    int n; /* The number of customers claimed. */
+    int i; /* Loop counter. */
+
+    teller_t t; /* The teller struct. */
+
+    /* Get the teller struct. */
+    t = tellers[*((int *) arg)];
+    rng_seed(&rng, seed + RNG_TELLER_STREAM + *((int *) arg));
+    place = t_place[*((int *) arg)];
+    trace_attach();
+    trace_name(t.teller_number);
+    b = branch_of(*((int *) arg));
+    q = &router.queues[b];
+
+    /* A customer waiting in the teller's batch could not renege, so with a patience the teller takes one at a time. */
+    max = admission.patience > 0 ? 1 : QUEUE_BATCH;
+
+    /* Loop until the end of the file has been reached and the queue is empty, or the teller is retired. */
+    while ((n = queue_get_batch(q, batch, max, *((int *) arg) - b_first[b])) > 0) {
+        place_sample(&placement, &place);
+        trace_counter(TRACE_QUEUE, queued());
+        live_depth(queued());
+        for (i = 0; i < n; i++) {
+            current_customer = batch[i];
+
+            /* Set the customer values. */
+            service_type = current_customer.service_type; /* Get the service type. */
+
+            /* Get the current time. */
+            response_time = now_ns();
+
+            /* Log the customer. */
+            log_response(&t, &current_customer, response_time);
+
+            /* Sleep for the service time, drawn from the distribution of the service type. */
+            if (no_sleep == FALSE) {
+                service_time = service_sample(&service[latency_type(service_type)], &rng);
+                sleep_until(response_time + service_time);
+            }
+
+            /* Increment the number of customers served. */
+            t.customers_served++;
+
+            /* Get the current time. */
+            completion_time = now_ns();
+
+            /* Record how long the customer waited and was served for. */
+            latency_record(t.latency, service_type, current_customer.intended_time, current_customer.arrival_time,
+                           response_time, completion_time);
+            live_served(*((int *) arg), current_customer.intended_time, current_customer.arrival_time, response_time,
+                        completion_time);
+            if (autoscaling == TRUE) {
+                autoscale_record(&scaler, *((int *) arg), response_time - current_customer.arrival_time,
+                                 completion_time - response_time);
+            }
+
+            /* Log the customer served. */
+            log_completion(&t, &current_customer, completion_time);
+            trace_span(t.teller_number, service_type, current_customer.customer_number, response_time, completion_time);
+        }
+    }
+
+    /* Set the teller end time. */
+    t.end_time = now_ns();
+
+    /* Write the teller log exit message. */
+    log_termination(&t);
+
+    tellers[*((int *) arg)] = t; /* Set the teller struct. This is to ensure that the new values are saved. */
+    t_place[*((int *) arg)] = place;
+    trace_detach();
+    live_retire(*((int *) arg));
+
+    /* Let the controller start this slot again. */
+    __atomic_store_n(&t_running[*((int *) arg)], FALSE, __ATOMIC_RELEASE);
+
+    /* Exit the thread. */
+    pthread_exit(NULL);
+    return NULL; /* To avoid warnings. */
+}
+
+/*************************************************************************
+ * Finish Service Function.
+ *
+ * This function ends the service of a customer by an event-loop teller:
+ * it counts the customer, records its latencies, publishes them, logs the
+ * completion and traces the service.
+ *
+ * @param t - The teller.
+ * @param c - The customer.
+ * @param response_time - The time the teller took the customer.
+ * @param completion_time - The time the service ended.
+ * @return void
+ *************************************************************************/
+static void finish_service(teller_t *t, const customer_t *c, long response_time, long completion_time) {
+    t->customers_served++;
+    latency_record(t->latency, c->service_type, c->intended_time, c->arrival_time, response_time, completion_time);
+    live_served(t->teller_number - 1, c->intended_time, c->arrival_time, response_time, completion_time);
+    log_completion(t, c, completion_time);
+    trace_span(t->teller_number, c->service_type, c->customer_number, response_time, completion_time);
+}
+
+/*************************************************************************
+ * Worker Function.
+ *
+ * This function is the entry point of the event-loop worker threads, used
+ * instead of a thread per teller with -e. Worker w serves the tellers w,
+ * w + n_workers, w + 2 * n_workers and so on, each as a small state
+ * machine: idle, or serving a customer until a deadline on the worker's
+ * timing wheel. The worker takes as many customers as it has idle
+ * tellers, waiting on the queue no later than the next deadline, then
+ * ends the services that are due and hands those tellers the next
+ * customers. Once the end of the file has been reached it finishes the
+ * services in progress. A teller costs a few words instead of a thread
+ * and its stack, and a worker sleeps once for all the services that end
+ * on the same tick. Services end on the first wheel tick (1ms) at or
+ * after their service time.
+ *
+ * @param arg - The index of the worker.
+ * @return void* - NULL.
+ *************************************************************************/
+void *worker(void *arg) {
+    int w = *((int *) arg);
+    int n_own = (n_tellers - w + n_workers - 1) / n_workers; /* The number of tellers this worker serves. */
+    customer_t *serving = malloc(sizeof(customer_t) * n_own); /* The customer each teller is serving. */
+    long *response = malloc(sizeof(long) * n_own); /* The time each teller took its customer. */
+    int *idle = malloc(sizeof(int) * n_own); /* The idle tellers, in the order they became idle. */
+    int head = 0; /* The position of the first idle teller. */
+    int n_idle = n_own; /* The number of idle tellers. */
+    int open = TRUE; /* TRUE until the end of the file has been reached and the queue is empty. */
+    wheel_t wheel; /* The service completions, by local teller index. */
+    rng_t rng; /* The generator for the service times of this worker's tellers. */
+    place_stat_t place; /* Where this worker ran. */
+    customer_t batch[QUEUE_BATCH]; /* The customers claimed from the queue. */
+    teller_t *t;
+    long now;
+    int n; /* The number of customers claimed. */
+    int i, j; /* Loop counters. */
+
+    if (serving == NULL || response == NULL || idle == NULL || wheel_init(&wheel, n_own, now_ns()) != 0) {
+        printf("Error: Failed to allocate worker thread %d.\n", w + 1);
+        exit(1);
+    }
+    rng_seed(&rng, seed + RNG_TELLER_STREAM + w);
+    place = t_place[w];
+    trace_attach();
+    for (j = 0; j < n_own; j++) {
+        idle[j] = j;
+        trace_name(tellers[w + j * n_workers].teller_number);
+    }
+
+    while (open == TRUE || wheel.count > 0) {
+        /* End the services that are due, and put their tellers at the back of the idle list. */
+        now = now_ns();
+        while ((j = wheel_expire(&wheel, now)) >= 0) {
+            finish_service(&tellers[w + j * n_workers], &serving[j], response[j], now);
+            idle[(head + n_idle) % n_own] = j;
+            n_idle++;
+        }
+
+        /* With no teller to hand a customer to, sleep until the next service ends. */
+        if (open == FALSE || n_idle == 0) {
+            if (wheel.count > 0) {
+                sleep_until(wheel_next(&wheel));
+            }
+            continue;
+        }
+
+        /* Hand the idle tellers new customers, waiting no later than the next service end. */
+        n = queue_get_until(c_queue, batch, n_idle < QUEUE_BATCH ? n_idle : QUEUE_BATCH, w, wheel_next(&wheel));
+        if (n == 0) {
+            open = FALSE;
+        } else if (n > 0) {
+            place_sample(&placement, &place);
+            trace_counter(TRACE_QUEUE, queue_count(c_queue));
+            live_depth(queue_count(c_queue));
+        }
+        for (i = 0; i < n; i++) {
+            j = idle[head];
+            t = &tellers[w + j * n_workers];
+            serving[j] = batch[i];
+            response[j] = now_ns();
+            log_response(t, &serving[j], response[j]);
+
+            /* Without the service sleeps the teller is done at once, and takes the next customer. */
+            if (no_sleep == TRUE) {
+                finish_service(t, &serving[j], response[j], now_ns());
+                continue;
+            }
+            head = (head + 1) % n_own;
+            n_idle--;
+            wheel_add(&wheel, j, response[j] + service_sample(&service[latency_type(batch[i].service_type)], &rng));
+        }
+    }
+
+    /* Every teller of the worker ends together. */
+    now = now_ns();
+    for (j = 0; j < n_own; j++) {
+        tellers[w + j * n_workers].end_time = now;
+        log_termination(&tellers[w + j * n_workers]);
+        live_retire(w + j * n_workers);
+    }
+    t_place[w] = place;
+    trace_detach();
+
+    wheel_destroy(&wheel);
+    free(serving);
+    free(response);
+    free(idle);
+    return NULL;
+}
+
+/*************************************************************************
+ * Controller Function.
+ *
+ * This function is the entry point of the autoscaling controller thread.
+ * Every AUTOSCALE_PERIOD_NS it samples the queue depth, the arrivals and
+ * the recent queue waits, and starts or retires tellers as the
+ * autoscaler decides. Each decision is written to the log file. The
+ * thread stops once the end of the file has been reached.
+ *
+ * @param arg - Unused.
+ * @return void* - NULL.
+ *************************************************************************/
+void *controller(void *arg) {
+    struct timespec period = {0, AUTOSCALE_PERIOD_NS};
+    char reason[MSG_LEN]; /* The reason for the decision. */
+    char msg[MSG_LEN * 2];
+    long last = now_ns(); /* The time of the last sample. */
+    long now;
+    int active = n_tellers; /* The number of tellers taking customers. */
+    int target; /* The number of tellers the autoscaler asks for. */
+    int i; /* Loop counter. */
+
+    (void) arg;
+
+    while (__atomic_load_n(&c_queue->end_of_file, __ATOMIC_ACQUIRE) == FALSE) {
+        nanosleep(&period, NULL);
+
+        now = now_ns();
+        reason[0] = '\0';
+        target = autoscale_sample(&scaler, active, queue_count(c_queue),
+                                  __atomic_load_n(&c_queue->arrivals, __ATOMIC_RELAXED), now - last, reason);
+        last = now;
+
+        if (target > active) {
+            /* A retired teller that is still serving its last batch keeps its slot until it finishes. */
+            for (i = active; i < target; i++) {
+                if (__atomic_load_n(&t_running[i], __ATOMIC_ACQUIRE) == TRUE) {
+                    break;
+                }
+            }
+            if (i == active) {
+                continue;
+            }
+            target = i;
+
+            queue_scale(c_queue, target);
+            for (i = active; i < target; i++) {
+                start_teller(i);
+            }
+        } else if (target < active) {
+            queue_scale(c_queue, target);
+        } else {
+            continue;
+        }
+
+        sprintf(msg, "Autoscale: %d -> %d tellers (%s)", active, target, reason);
+        wrt_log(msg);
+        active = target;
+    }
+
+    return NULL;
+}
+
+/*************************************************************************
+ *                            Helper Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Start Teller Function.
+ *
+ * This function starts the teller thread of a slot. A slot that was used
+ * before is joined first, and keeps its statistics and start time.
+ *
+ * @param i - The index of the teller slot.
+ * @return void
+ *************************************************************************/
+void start_teller(int i) {
+    pthread_attr_t attr; /* The attributes of the teller thread. */
+
+    if (t_joinable[i] == TRUE) {
+        pthread_join(t_threads[i], NULL);
+    }
+
+    if (tellers[i].teller_number == 0) {
+        tellers[i].teller_number = i + 1;
+        tellers[i].customers_served = 0;
+
+        /* Set the teller start time. */
+        tellers[i].start_time = now_ns();
+    }
+    live_teller(i, tellers[i].teller_number, tellers[i].start_time);
+
+    t_running[i] = TRUE;
+    t_joinable[i] = TRUE;
+
+    /* The below line is initializing the teller thread with the teller function.
+     * pthread_create(<address of thread>, <thread attributes>, <teller function to run>, <teller slot>)
+     * The teller slots take the places after the customer threads.
+     */
+    if (place_attr(&placement, &attr, n_producers + i) != 0
+        || pthread_create(&t_threads[i], &attr, teller, (void *) &t_thread_numbers[i]) != 0) {
+        printf("Error: Failed to create teller thread %d.\n", i + 1);
+        exit(1);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+/*************************************************************************
+ * Start Group Function.
+ *
+ * This function forks the process that runs teller group g, the tellers
+ * from g * n_tellers / n_groups up to the first teller of the next group.
+ * The child starts its own logger thread and its teller threads, waits
+ * for them and exits. The queue and the teller stats are in shared
+ * memory, so the parent sees everything the child's tellers do. The
+ * processes only share a queue, they are not isolated from each other's
+ * faults: a child that dies holding the queue mutex, or between claiming
+ * a ring slot and reading it, leaves the others waiting.
+ *
+ * @param g - The index of the teller group.
+ * @return void
+ *************************************************************************/
+void start_group(int g) {
+    int first = g * n_tellers / n_groups; /* The first teller of the group. */
+    int last = (g + 1) * n_tellers / n_groups; /* The first teller of the next group. */
+    int i; /* Loop counter. */
+
+    /* Write out what stdio holds, so the child does not write it again. */
+    fflush(NULL);
+    g_pids[g] = fork();
+    if (g_pids[g] < 0) {
+        printf("Error: Failed to create teller process %d.\n", g + 1);
+        exit(1);
+    }
+    if (g_pids[g] > 0) {
+        return;
+    }
+
+    /* The child. CTRL+C stops it quietly, and the parent reports it. */
+    signal(SIGINT, SIG_DFL);
+    if (logger_restart(log_file) != 0 || evlog_restart() != 0) {
+        _exit(1);
+    }
+    for (i = first; i < last; i++) {
+        start_teller(i);
+    }
+    for (i = first; i < last; i++) {
+        pthread_join(t_threads[i], NULL);
+    }
+    evlog_close();
+    logger_stop();
+    _exit(0);
+}
+
+/*************************************************************************
+ * Log Function.
+ *
+ * This function writes the log file. While the logger thread is running
+ * the message is only queued, so callers holding the queue mutex never
+ * wait on the disk.
+ *
+ * @param msg - The message to be written to the log file.
+ * @return void
+ *************************************************************************/
+void wrt_log(const char *msg) {
+    if (logger_write(msg) == TRUE) {
+        return;
+    }
+
+    /* Lock the log file. */
+    pthread_mutex_lock(&log_mutex);
+
+    if (log_file == NULL) {
+        log_file = fopen(LOG_FILE, "w");
+        if (log_file == NULL) {
+            fprintf(stderr, "Error opening log file.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    fprintf(log_file, "%s\n", msg);
+    fflush(log_file); /* Print the message to the log file. */
+
+    pthread_mutex_unlock(&log_mutex);
+}
+
+/*************************************************************************
+ * Print Debug Function.
+ *
+ * This function prints a debug message if the DEBUG flag is set.
+ *
+ * @param msg - The message to be printed.
+ * @return void
+ *************************************************************************/
+void debug(const char *msg) {
+
+    /* Lock the debug file. */
+
+    pthread_mutex_lock(&debug_mutex);
+    if (debug_file == NULL) {
+        debug_file = fopen(DEBUG_FILE, "w");
+        if (debug_file == NULL) {
+            fprintf(stderr, "Error opening debug file.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    fprintf(debug_file, "%s\n", msg);
+    fflush(debug_file);
+
+    pthread_mutex_unlock(&debug_mutex);
+}
+
+/*************************************************************************
+ * Init Clock Function.
+ *
+ * This function caches the local wall-clock time of day that matches the
+ * current CLOCK_MONOTONIC time. Times are kept as CLOCK_MONOTONIC
+ * nanoseconds and only turned into a wall-clock time when they are
+ * logged, without calling back into libc.
+ *
+ * @return void
+ *************************************************************************/
+void init_clock(void) {
+    struct tm tm_info;
+    time_t tt;
+
+    tt = time(NULL);
+    clock_base_ns = now_ns();
+    localtime_r(&tt, &tm_info);
+    clock_base_day = tm_info.tm_hour * 3600L + tm_info.tm_min * 60L + tm_info.tm_sec;
+}
+
+/*************************************************************************
+ * Format Time Function.
+ *
+ * This function fills a string with the wall-clock time of a
+ * CLOCK_MONOTONIC time, in the HH:MM:SS form used throughout the log file.
+ *
+ * @param ns - The CLOCK_MONOTONIC time, in nanoseconds.
+ * @param time_str - The pointer to the string to be filled with the time.
+ * @return void
+ *************************************************************************/
+void format_time(long ns, char *time_str) {
+    long seconds = clock_base_day + (ns - clock_base_ns) / 1000000000L;
+
+    seconds %= 86400L;
+    if (seconds < 0) {
+        seconds += 86400L;
+    }
+
+    time_str[0] = (char) ('0' + seconds / 36000);
+    time_str[1] = (char) ('0' + seconds / 3600 % 10);
+    time_str[2] = ':';
+    time_str[3] = (char) ('0' + seconds % 3600 / 600);
+    time_str[4] = (char) ('0' + seconds % 3600 / 60 % 10);
+    time_str[5] = ':';
+    time_str[6] = (char) ('0' + seconds % 60 / 10);
+    time_str[7] = (char) ('0' + seconds % 10);
+    time_str[8] = '\0';
+}
+
+/*************************************************************************
+ * Monotonic Clock Function.
+ *
+ * @return long - The current CLOCK_MONOTONIC time, in nanoseconds.
+ *************************************************************************/
+long now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/*************************************************************************
+ * Sleep Until Function.
+ *
+ * This function sleeps until an absolute CLOCK_MONOTONIC deadline, so a
+ * series of sleeps does not drift.
+ *
+ * @param deadline - The time to wake up, in nanoseconds.
+ * @return void
+ *************************************************************************/
+void sleep_until(long deadline) {
+    struct timespec ts;
+
+    ts.tv_sec = deadline / 1000000000L;
+    ts.tv_nsec = deadline % 1000000000L;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        /* Interrupted by a signal, so sleep again. */
+    }
+}
+
+/*************************************************************************
+ * Log Arrival Function.
+ *
+ * This function writes the arrival of a customer to the log file.
+ *
+ * @param c - The customer that arrived in the queue.
+ * @return void
+ *************************************************************************/
+void log_arrival(const customer_t *c) {
+    char msg[MSG_LEN];
+    char arrival_time[9];
+
+    if (evlog_write(EVLOG_ARRIVAL, 0, c->customer_number, c->service_type, c->arrival_time, c->arrival_time) == TRUE) {
+        return;
+    }
+
+    format_time(c->arrival_time, arrival_time);
+    wrt_log("-----------------------------------------------------------------------");
+    sprintf(msg, "Customer %ld: %c\nArrival time: %s", c->customer_number, c->service_type, arrival_time);
+    wrt_log(msg);
+    wrt_log("-----------------------------------------------------------------------\n");
+}
+
+/*************************************************************************
+ * Log Departure Function.
+ *
+ * This function writes a customer leaving without being served to the
+ * log file.
+ *
+ * @param c - The customer that left.
+ * @param reason - How it left: "Balked", "Rejected" or "Reneged".
+ * @param time - The time it left, in ns.
+ * @return void
+ *************************************************************************/
+void log_departure(const customer_t *c, const char *reason, long time) {
+    char msg[MSG_LEN];
+    char left[9];
+    int type = strcmp(reason, "Balked") == 0 ? EVLOG_BALKED
+               : (strcmp(reason, "Rejected") == 0 ? EVLOG_REJECTED : EVLOG_RENEGED);
+
+    if (evlog_write(type, 0, c->customer_number, c->service_type, c->arrival_time, time) == TRUE) {
+        return;
+    }
+
+    format_time(time, left);
+    wrt_log("-----------------------------------------------------------------------");
+    sprintf(msg, "Customer %ld: %c\n%s time: %s", c->customer_number, c->service_type, reason, left);
+    wrt_log(msg);
+    wrt_log("-----------------------------------------------------------------------\n");
+}
+
+/*************************************************************************
+ * Log Response Function.
+ *
+ * This function writes a teller taking a customer from the queue to the
+ * log file.
+ *
+ * @param t - The teller serving the customer.
+ * @param c - The customer being served.
+ * @param response_time - The time the teller took the customer, in ns.
+ * @return void
+ *************************************************************************/
+void log_response(const teller_t *t, const customer_t *c, long response_time) {
+    char msg[MSG_LEN];
+    char arrival[9];
+    char response[9];
+
+    if (evlog_write(EVLOG_RESPONSE, t->teller_number, c->customer_number, c->service_type, c->arrival_time,
+                    response_time) == TRUE) {
+        return;
+    }
+    format_time(c->arrival_time, arrival);
+    format_time(response_time, response);
+
+    sprintf(msg, "Teller: %d\nCustomer: %ld\nService: %c\nArrival Time: %s\nResponse Time: %s\n",
+            t->teller_number, c->customer_number, c->service_type, arrival, response);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Completion Function.
+ *
+ * This function writes a teller finishing with a customer to the log file.
+ *
+ * @param t - The teller that served the customer.
+ * @param c - The customer that was served.
+ * @param completion_time - The time the teller finished with the customer, in ns.
+ * @return void
+ *************************************************************************/
+void log_completion(const teller_t *t, const customer_t *c, long completion_time) {
+    char msg[MSG_LEN];
+    char arrival[9];
+    char completion[9];
+
+    if (evlog_write(EVLOG_COMPLETION, t->teller_number, c->customer_number, c->service_type, c->arrival_time,
+                    completion_time) == TRUE) {
+        return;
+    }
+    format_time(c->arrival_time, arrival);
+    format_time(completion_time, completion);
+
+    sprintf(msg, "Teller: %d\nCustomer: %ld\nArrival Time: %s\nCompletion Time: %s\n",
+            t->teller_number, c->customer_number, arrival, completion);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Termination Function.
+ *
+ * This function writes the teller exit message to the log file.
+ *
+ * @param t - The teller that is terminating.
+ * @return void
+ *************************************************************************/
+void log_termination(const teller_t *t) {
+    char msg[MSG_LEN];
+    char start[9];
+    char end[9];
+
+    if (evlog_write(EVLOG_TERMINATION, t->teller_number, t->customers_served, '\0', t->start_time, t->end_time)
+        == TRUE) {
+        return;
+    }
+    format_time(t->start_time, start);
+    format_time(t->end_time, end);
+
+    sprintf(msg, "Termination: teller-%d\n#served customers: %d\nStart time: %s\nTermination time: %s\n",
+            t->teller_number, t->customers_served, start, end);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Statistics Function.
+ *
+ * This function writes the number of customers served by each teller,
+ * and the total, to the log file.
+ *
+ * @param t - The array of tellers.
+ * @param n - The number of tellers in the array.
+ * @return void
+ *************************************************************************/
+void log_statistics(const teller_t *t, int n) {
+    char msg[MSG_LEN];
+    int i; /* Loop counter. */
+    int teller_total = 0; /* Total number of customers served by all tellers. */
+
+    wrt_log("Teller Statistic");
+    for (i = 0; i < n; i++) {
+        sprintf(msg, "Teller-%d serves %d customers.", t[i].teller_number, t[i].customers_served);
+        wrt_log(msg);
+        teller_total += t[i].customers_served;
+    }
+    sprintf(msg, "\nTotal customers served: %d\n", teller_total);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Overload Function.
+ *
+ * This function writes how many customers left without being served,
+ * after the number served.
+ *
+ * @param reneged - The number of customers that reneged.
+ * @return void
+ *************************************************************************/
+void log_overload(unsigned long reneged) {
+    char msg[MSG_LEN];
+
+    sprintf(msg, "Customers balked: %lu, rejected: %lu, reneged: %lu\n", balked, rejected, reneged);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Locks Function.
+ *
+ * This function writes how many times the customer queue's locks were
+ * taken, in total and per customer served.
+ *
+ * @param locks - The number of lock acquisitions.
+ * @param t - The array of tellers.
+ * @param n - The number of tellers in the array.
+ * @return void
+ *************************************************************************/
+void log_locks(unsigned long locks, const teller_t *t, int n) {
+    char msg[MSG_LEN];
+    long customers = 0; /* Total number of customers served by all tellers. */
+    int i; /* Loop counter. */
+
+    for (i = 0; i < n; i++) {
+        customers += t[i].customers_served;
+    }
+    sprintf(msg, "Queue lock acquisitions: %lu (%.2f per customer)\n", locks,
+            customers > 0 ? (double) locks / customers : 0.0);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Waits Function.
+ *
+ * This function writes how the tellers and producers waited on the
+ * queue: how many waits ended while spinning, and how many parked.
+ *
+ * @param w - The wait strategy.
+ * @param spun - The number of waits that ended while spinning.
+ * @param parks - The number of times a thread parked.
+ * @return void
+ *************************************************************************/
+void log_waits(const wait_t *w, unsigned long spun, unsigned long parks) {
+    char msg[MSG_LEN];
+
+    if (w->type == WAIT_ADAPTIVE) {
+        sprintf(msg, "Queue waits (adaptive, %d spins, %d yields): %lu ended spinning, %lu parked\n", w->spins,
+                w->yields, spun, parks);
+    } else {
+        sprintf(msg, "Queue waits (%s): %lu parked\n", wait_name(w->type), parks);
+    }
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Placement Function.
+ *
+ * This function writes where each customer and teller thread ran: its
+ * place, how many times it moved to another CPU, and how many of its
+ * batches it took or added from outside the home node, where the queue
+ * is allocated.
+ *
+ * @param n - The number of teller slots, or workers, that were used.
+ * @param label - What the threads after the customer threads are, "Teller" or "Worker".
+ * @return void
+ *************************************************************************/
+void log_placement(int n, const char *label) {
+    char msg[MSG_LEN];
+    char where[32]; /* The place of the thread. */
+    int i; /* Loop counter. */
+
+    sprintf(msg, "Placement Statistic (home node %d)", placement.home);
+    wrt_log(msg);
+    for (i = 0; i < n_producers + n; i++) {
+        const place_stat_t *s = i < n_producers ? &c_place[i] : &t_place[i - n_producers];
+
+        place_describe(&placement, i, where);
+        sprintf(msg, "%s-%d (%s): %lu migrations, %lu of %lu batches from another node.",
+                i < n_producers ? "Customer" : label, i < n_producers ? i + 1 : i - n_producers + 1,
+                where, s->migrations, s->remote, s->accesses);
+        wrt_log(msg);
+    }
+    wrt_log("");
+}
+
+/*************************************************************************
+ * Print Bench Function.
+ *
+ * This function prints the throughput and latency of a run to stdout as
+ * one CSV line, for the benchmark script:
+ * customers,seconds,ops_per_sec,locks_per_customer,wait_p50_us,wait_p99_us,
+ * total_p50_us,total_p99_us,total_p999_us
+ *
+ * @param t - The array of tellers.
+ * @param n - The number of tellers in the array.
+ * @param elapsed - The time the run took, in nanoseconds.
+ * @param locks - The number of queue lock acquisitions.
+ * @return void
+ *************************************************************************/
+void print_bench(const teller_t *t, int n, long elapsed, unsigned long locks) {
+    hist_t *wait = calloc(1, sizeof(hist_t));
+    hist_t *total = calloc(1, sizeof(hist_t));
+    double seconds = elapsed / 1e9;
+    int i, k; /* Loop counters. */
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < LAT_TYPES; k++) {
+            hist_merge(wait, &t[i].latency->h[LAT_WAIT][k]);
+            hist_merge(total, &t[i].latency->h[LAT_TOTAL][k]);
+        }
+    }
+
+    printf("%lu,%.6f,%.0f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", total->count, seconds,
+           seconds > 0 ? total->count / seconds : 0.0,
+           total->count > 0 ? (double) locks / total->count : 0.0,
+           hist_percentile(wait, 50.0) / 1e3, hist_percentile(wait, 99.0) / 1e3,
+           hist_percentile(total, 50.0) / 1e3, hist_percentile(total, 99.0) / 1e3,
+           hist_percentile(total, 99.9) / 1e3);
+
+    free(wait);
+    free(total);
+}
+
+/*************************************************************************
+ * Log Latency Line Function.
+ *
+ * This function writes one line of the latency report.
+ *
+ * @param name - The name of the latency metric.
+ * @param h - The histogram of the latency metric.
+ * @return void
+ *************************************************************************/
+void log_latency_line(const char *name, const hist_t *h) {
+    char msg[MSG_LEN];
+
+    sprintf(msg, "  %-8s mean=%.3f p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f", name,
+            h->count > 0 ? h->sum / h->count / 1e6 : 0.0, hist_percentile(h, 50.0) / 1e6, hist_percentile(h, 90.0) / 1e6, hist_percentile(h, 99.0) / 1e6,
+            hist_percentile(h, 99.9) / 1e6, h->max / 1e6);
+    wrt_log(msg);
+}
+
+/*************************************************************************
+ * Log Latency Function.
+ *
+ * This function merges the latency histograms of the tellers and writes
+ * the queue wait, service, end-to-end and producer lag percentiles, in
+ * milliseconds, for each service type and for each teller.
+ *
+ * @param t - The array of tellers.
+ * @param n - The number of tellers in the array.
+ * @param label - What each record in t is, "Teller", or "Worker" when it
+ *                holds the latencies of all the tellers a worker served.
+ * @return void
+ *************************************************************************/
+void log_latency(const teller_t *t, int n, const char *label) {
+    static const char types[LAT_TYPES] = {'W', 'D', 'I'};
+    static const char *names[LAT_METRICS] = {"Wait", "Service", "Total", "Lag"};
+    hist_t *merged = calloc(1, sizeof(hist_t));
+    char msg[MSG_LEN];
+    int i, j, k; /* Loop counters. */
+
+    wrt_log("Latency Statistic (ms)");
+
+    /* Each service type, across all the tellers. */
+    for (k = 0; k < LAT_TYPES; k++) {
+        for (j = 0; j < LAT_METRICS; j++) {
+            memset(merged, 0, sizeof(hist_t));
+            for (i = 0; i < n; i++) {
+                hist_merge(merged, &t[i].latency->h[j][k]);
+            }
+            if (j == 0) {
+                sprintf(msg, "Service %c: %lu customers", types[k], merged->count);
+                wrt_log(msg);
+            }
+            log_latency_line(names[j], merged);
+        }
+    }
+
+    /* Each teller, across all the service types. */
+    for (i = 0; i < n; i++) {
+        sprintf(msg, "%s-%d: %d customers", label, t[i].teller_number, t[i].customers_served);
+        wrt_log(msg);
+        for (j = 0; j < LAT_METRICS; j++) {
+            memset(merged, 0, sizeof(hist_t));
+            for (k = 0; k < LAT_TYPES; k++) {
+                hist_merge(merged, &t[i].latency->h[j][k]);
+            }
+            log_latency_line(names[j], merged);
+        }
+    }
+    wrt_log("");
+
+    free(merged);
+}
+
+/*************************************************************************
+ * Log Branches Function.
+ *
+ * This function writes the routing policy, then the queue wait and
+ * end-to-end percentiles of each branch, in milliseconds, merged across
+ * its tellers and service types.
+ *
+ * @param t - The array of tellers.
+ * @param n - The number of tellers in the array.
+ * @return void
+ *************************************************************************/
+void log_branches(const teller_t *t, int n) {
+    static const char *policies[] = {"random", "rr", "jsq", "p2c"};
+    hist_t *wait = calloc(1, sizeof(hist_t));
+    hist_t *total = calloc(1, sizeof(hist_t));
+    char msg[MSG_LEN];
+    int b, i, k; /* Loop counters. */
+
+    sprintf(msg, "Branch Statistic (%d branches, %s)", n_branches, policies[router.policy]);
+    wrt_log(msg);
+    for (b = 0; b < n_branches; b++) {
+        memset(wait, 0, sizeof(hist_t));
+        memset(total, 0, sizeof(hist_t));
+        for (i = b_first[b]; i < b_first[b + 1] && i < n; i++) {
+            for (k = 0; k < LAT_TYPES; k++) {
+                hist_merge(wait, &t[i].latency->h[LAT_WAIT][k]);
+                hist_merge(total, &t[i].latency->h[LAT_TOTAL][k]);
+            }
+        }
+        sprintf(msg, "Branch-%d: tellers %d-%d, %lu customers", b + 1, b_first[b] + 1, b_first[b + 1], total->count);
+        wrt_log(msg);
+        log_latency_line("Wait", wait);
+        log_latency_line("Total", total);
+    }
+    wrt_log("");
+
+    free(wait);
+    free(total);
+}
+
+/*************************************************************************
+ * Usage Function.
+ *
+ * This function prints how to run the program.
+ *
+ * @param name - The file name of the program.
+ * @return void
+ *************************************************************************/
+void usage(const char *name) {
+    printf("Usage: %s [options] <m> <t_C> <t_W> <t_D> <t_I>\n", name);
+    printf("  m  - The size/length of the customer queue.\n");
+    printf("  t_C - The customer arrival period.\n");
+    printf("  t_W - The time duration of a withdrawal.\n");
+    printf("  t_D - The time duration of a deposit.\n");
+    printf("  t_I - The time duration of an information query.\n");
+    printf("\nOptions:\n");
+    printf("  -s - Simulate the run on a virtual clock instead of sleeping.\n");
+    printf("  -q <type> - The customer queue: mutex (default), lockfree or steal.\n");
+    printf("  -t <n> - The number of tellers (default %d).\n", T_THREADS);
+    printf("  -p <n> - The number of customer threads, each reading a shard of c_file (default 1).\n");
+    printf("  -a <min:max> - Start and retire tellers with the load, between min and max tellers.\n");
+    printf("  -r <rate>[:poisson|:fixed] - Open-loop arrivals at rate customers per second (default poisson).\n");
+    printf("  -d <T:dist> - The service time distribution of service type T (W, D or I): fixed (default),\n");
+    printf("                exp, lognormal[:sigma] or empirical:<file>. The mean is t_T, or the file's mean.\n");
+    printf("  -R <seed> - The seed of the arrival and service time generators (default 1).\n");
+    printf("  -P <cpus|node:nodes> - Pin the customer threads, then the tellers, to the CPUs or NUMA nodes in turn,\n");
+    printf("                e.g. 0-3,8 or node:0,1. The queue is allocated on the node of the first.\n");
+    printf("  -W <strategy> - How idle tellers and full producers wait: condvar (default), futex, or\n");
+    printf("                adaptive[:spins[:yields]] to spin, then yield, then park on a futex.\n");
+    printf("  -e <n> - Serve the tellers from n event-loop worker threads instead of a thread per teller.\n");
+    printf("  -T <file> - Write a Chrome Trace Event JSON timeline of the tellers and the queue to file.\n");
+    printf("  -g <n> - Run the tellers in n processes, sharing the lockfree queue and the stats through shared memory.\n");
+    printf("  -L <name> - Publish live statistics in the shared memory segment name while the program runs.\n");
+    printf("  -M <name> - Print the live statistics a run publishes under name every second, instead of running.\n");
+    printf("  -X <file> - Simulate every configuration in file, one per thread, and print a CSV, instead of running.\n");
+    printf("                Each line is <m> <t_C> <t_W> <t_D> <t_I> [tellers]; a field can be a list of\n");
+    printf("                numbers and lo-hi[:step] ranges, e.g. 4,8,16 or 1-8:2, and every combination is run.\n");
+    printf("  -j <n> - The number of threads for -X and -C (default one per CPU).\n");
+    printf("  -C <wait|total>:<p>:<ms> - Find the fewest tellers (up to -t) and smallest queue (up to m) that keep\n");
+    printf("                the p-th percentile queue wait or end-to-end time below ms, instead of running.\n");
+    printf("  -N <n> - The number of seeded runs of each configuration for -C (default 5).\n");
+    printf("  -B <n>[:policy] - Split the tellers into n branches, each with its own queue of m, and route each\n");
+    printf("                customer with random, rr, jsq (shortest queue) or p2c (default, shorter of two).\n");
+    printf("  -O <behaviour> - What happens to the customers under overload; repeat to combine:\n");
+    printf("                balk[:depth] - Leave at once if depth (default m) customers are waiting.\n");
+    printf("                renege:<ms> - Leave the queue after waiting ms without being served.\n");
+    printf("                  Only with the mutex queue in fifo order, not -q lockfree, -q steal, -g or -S.\n");
+    printf("                bucket:<rate>[:<burst>] - Admit at most rate customers a second, in bursts of burst.\n");
+    printf("  -l <file> - Write the customer and teller events to file as 32-byte binary records instead of to r_log.\n");
+    printf("  -D [csv:]<file> - Print the events of a -l log as the text r_log would have had, or as CSV.\n");
+    printf("  -S <policy> - The scheduling policy: fifo (default), sjf, priority or wfq.\n");
+    printf("  -w <W:D:I> - The weights of the service types for priority and wfq (default 1:1:1).\n");
+    printf("  -n - Do not sleep for the arrivals or the service times.\n");
+    printf("  -b - Print the throughput and latency of the run as a CSV line.\n");
+    printf("\nExample: %s 100 5 2 2 1\n", name);
+}
+
+/*************************************************************************
+ * Sig Handler Function.
+ *
+ * This function is called when the program receives a SIGINT signal. It
+ * prints the number of customers served by each teller and the total number
+ * of customers served.
+ * The SIGINT signal is sent when the user presses CTRL+C.
+ *
+ * @param sig - The signal number.
+ * @return void
+ *************************************************************************/
+void sig_handler(int signo) {
+    if (signo == SIGINT) {
+        printf("\n");
+        printf("The program was interrupted by the user.\n");
+        live_interrupt(); /* Keep the live statistics readable. */
+        exit(0);
+    }
+}
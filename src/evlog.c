@@ -0,0 +1,369 @@
+#include "evlog.h"
+#include <sched.h> /* For sched_yield() */
+#include <fcntl.h> /* For open() */
+#include <errno.h>
+
+/*************************************************************************
+ *                            Global Variables                           *
+ *************************************************************************/
+
+static ring_t ev_ring; /* The records waiting to be written. */
+static evlog_record_t *ev_batch; /* The records collected for the next write(). */
+static pthread_t ev_thread; /* The writer thread. */
+static int ev_fd = -1; /* The file descriptor of the event log. */
+static int ev_running = FALSE; /* TRUE while the writer thread is accepting records. */
+static int ev_stop = FALSE; /* Set to TRUE to make the writer thread drain and exit. */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Write All Function.
+ *
+ * This function writes a buffer in full, picking up where a short write
+ * stopped. The file is opened with O_APPEND, so the writes of teller
+ * processes sharing it land whole, one after the other.
+ *
+ * @param buf - The bytes to be written.
+ * @param len - The number of bytes.
+ * @return void
+ *************************************************************************/
+static void write_all(const char *buf, size_t len) {
+    ssize_t written;
+
+    while (len > 0) {
+        written = write(ev_fd, buf, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error writing event log.\n");
+            return;
+        }
+        buf += written;
+        len -= written;
+    }
+}
+
+/*************************************************************************
+ * Writer Thread Function.
+ *
+ * This function collects records from the ring into ev_batch, and
+ * writes the batch with one write() when it is full, or when it has
+ * waited EVLOG_FLUSH_NS. Once ev_stop is set the ring is drained before
+ * the thread exits.
+ *
+ * @param arg - Unused.
+ * @return void* - NULL.
+ *************************************************************************/
+static void *writer(void *arg) {
+    evlog_record_t *batch = ev_batch;
+    struct timespec idle = {0, 1000000}; /* Sleep 1ms when there is nothing to write. */
+    long first = 0; /* The time the oldest record in the batch was collected. */
+    int n = 0; /* The number of records in the batch. */
+    int stop;
+
+    (void) arg;
+
+    for (;;) {
+        stop = __atomic_load_n(&ev_stop, __ATOMIC_ACQUIRE);
+
+        if (ring_pop(&ev_ring, &batch[n]) == TRUE) {
+            if (n == 0) {
+                first = now_ns();
+            }
+            if (++n == EVLOG_BATCH) {
+                write_all((const char *) batch, sizeof(evlog_record_t) * n);
+                n = 0;
+            }
+            continue;
+        }
+
+        /* The ring is empty. */
+        if (n > 0 && (stop == TRUE || now_ns() - first >= EVLOG_FLUSH_NS)) {
+            write_all((const char *) batch, sizeof(evlog_record_t) * n);
+            n = 0;
+        }
+
+        if (stop == TRUE) {
+            break; /* The ring was drained after ev_stop was seen. */
+        }
+        nanosleep(&idle, NULL);
+    }
+
+    return NULL;
+}
+
+/*************************************************************************
+ * Start Function.
+ *
+ * This function allocates the ring and the batch, then starts the writer
+ * thread.
+ *
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+static int start(void) {
+    ev_stop = FALSE;
+    if (ring_init(&ev_ring, EVLOG_RING, sizeof(evlog_record_t)) != 0) {
+        printf("Error: Failed to allocate the event log ring.\n");
+        return 1;
+    }
+    ev_batch = malloc(sizeof(evlog_record_t) * EVLOG_BATCH);
+    if (ev_batch == NULL) {
+        printf("Error: Failed to allocate the event log batch.\n");
+        ring_destroy(&ev_ring);
+        return 1;
+    }
+    if (pthread_create(&ev_thread, NULL, writer, NULL) != 0) {
+        printf("Error: Failed to create the event log thread.\n");
+        free(ev_batch);
+        ev_batch = NULL;
+        ring_destroy(&ev_ring);
+        return 1;
+    }
+    __atomic_store_n(&ev_running, TRUE, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/*************************************************************************
+ * Decode Time Function.
+ *
+ * This function formats a time of day as format_time() does, from the
+ * clock base in the log's header.
+ *
+ * @param h - The header of the log.
+ * @param ns - The CLOCK_MONOTONIC time, in ns.
+ * @param time_str - Filled with the time, as HH:MM:SS.
+ * @return void
+ *************************************************************************/
+static void decode_time(const evlog_header_t *h, long ns, char *time_str) {
+    long seconds = (h->clock_base_day + (ns - h->clock_base_ns) / 1000000000L) % 86400L;
+
+    if (seconds < 0) {
+        seconds += 86400L;
+    }
+    sprintf(time_str, "%02ld:%02ld:%02ld", seconds / 3600, seconds % 3600 / 60, seconds % 60);
+}
+
+/*************************************************************************
+ * Print Text Function.
+ *
+ * This function prints a record in the text that r_log has for it
+ * without -l.
+ *
+ * @param h - The header of the log.
+ * @param r - The record.
+ * @return void
+ *************************************************************************/
+static void print_text(const evlog_header_t *h, const evlog_record_t *r) {
+    static const char *dashes = "-----------------------------------------------------------------------";
+    static const char *reasons[] = {"Balked", "Rejected", "Reneged"};
+    char time[9];
+    char arrival[9];
+
+    decode_time(h, r->time, time);
+    decode_time(h, r->arrival, arrival);
+    switch (r->type) {
+        case EVLOG_ARRIVAL:
+            printf("%s\nCustomer %ld: %c\nArrival time: %s\n%s\n\n", dashes, r->customer, r->service_type, arrival,
+                   dashes);
+            break;
+        case EVLOG_RESPONSE:
+            printf("Teller: %d\nCustomer: %ld\nService: %c\nArrival Time: %s\nResponse Time: %s\n\n", r->teller,
+                   r->customer, r->service_type, arrival, time);
+            break;
+        case EVLOG_COMPLETION:
+            printf("Teller: %d\nCustomer: %ld\nArrival Time: %s\nCompletion Time: %s\n\n", r->teller, r->customer,
+                   arrival, time);
+            break;
+        case EVLOG_TERMINATION:
+            printf("Termination: teller-%d\n#served customers: %ld\nStart time: %s\nTermination time: %s\n\n",
+                   r->teller, r->customer, arrival, time);
+            break;
+        default: /* EVLOG_BALKED, EVLOG_REJECTED or EVLOG_RENEGED */
+            printf("%s\nCustomer %ld: %c\n%s time: %s\n%s\n\n", dashes, r->customer, r->service_type,
+                   reasons[r->type - EVLOG_BALKED], time, dashes);
+            break;
+    }
+}
+
+/*************************************************************************
+ *                           Event Log Functions                         *
+ *************************************************************************/
+
+/*************************************************************************
+ * Event Log Open Function.
+ *
+ * This function creates the event log file, writes its header and starts
+ * the writer thread. From then on the customer and teller events are
+ * written to it as fixed-size records instead of as text to r_log.
+ *
+ * @param path - The event log file.
+ * @param clock_base_ns - The CLOCK_MONOTONIC time matching clock_base_day.
+ * @param clock_base_day - The local wall-clock time of day at clock_base_ns.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int evlog_open(const char *path, long clock_base_ns, long clock_base_day) {
+    evlog_header_t h;
+
+    ev_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (ev_fd < 0) {
+        printf("Error: Failed to create the event log %s.\n", path);
+        return 1;
+    }
+    memset(&h, 0, sizeof(evlog_header_t));
+    memcpy(h.magic, EVLOG_MAGIC, sizeof(h.magic));
+    h.record_size = sizeof(evlog_record_t);
+    h.clock_base_ns = clock_base_ns;
+    h.clock_base_day = clock_base_day;
+    write_all((const char *) &h, sizeof(evlog_header_t));
+    if (start() != 0) {
+        close(ev_fd);
+        ev_fd = -1;
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Event Log Restart Function.
+ *
+ * This function starts a new writer thread in a child process, as
+ * logger_restart() does for the log file. The records still in the
+ * copied ring and batch are the parent's to write, so the child drops
+ * them.
+ *
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int evlog_restart(void) {
+    if (__atomic_load_n(&ev_running, __ATOMIC_ACQUIRE) == FALSE) {
+        return 0;
+    }
+    ring_destroy(&ev_ring);
+    free(ev_batch);
+    ev_batch = NULL;
+    __atomic_store_n(&ev_running, FALSE, __ATOMIC_RELEASE);
+    return start();
+}
+
+/*************************************************************************
+ * Event Log Close Function.
+ *
+ * This function writes every record still in the ring, stops the writer
+ * thread and closes the file. It must be called once the other threads
+ * have stopped logging.
+ *
+ * @return void
+ *************************************************************************/
+void evlog_close(void) {
+    if (__atomic_load_n(&ev_running, __ATOMIC_ACQUIRE) == FALSE) {
+        return;
+    }
+
+    __atomic_store_n(&ev_running, FALSE, __ATOMIC_RELEASE);
+    __atomic_store_n(&ev_stop, TRUE, __ATOMIC_RELEASE);
+    pthread_join(ev_thread, NULL);
+    ring_destroy(&ev_ring);
+    free(ev_batch);
+    ev_batch = NULL;
+    close(ev_fd);
+    ev_fd = -1;
+}
+
+/*************************************************************************
+ * Event Log Write Function.
+ *
+ * This function copies an event into the ring. If the ring is full the
+ * caller yields until the writer thread has made room.
+ *
+ * @param type - The event type.
+ * @param teller - The teller number, or 0.
+ * @param customer - The customer number, or the number served for a
+ *                   termination.
+ * @param service_type - The service type of the customer.
+ * @param arrival - The time the customer arrived, or the teller started
+ *                  for a termination, in ns.
+ * @param time - The time of the event, in ns.
+ * @return int - TRUE if the event was queued, FALSE if there is no
+ *               event log.
+ *************************************************************************/
+int evlog_write(int type, int teller, long customer, char service_type, long arrival, long time) {
+    evlog_record_t r;
+
+    if (__atomic_load_n(&ev_running, __ATOMIC_ACQUIRE) == FALSE) {
+        return FALSE;
+    }
+
+    r.time = time;
+    r.customer = customer;
+    r.arrival = arrival;
+    r.teller = teller;
+    r.type = (char) type;
+    r.service_type = service_type;
+    r.pad[0] = 0;
+    r.pad[1] = 0;
+    while (ring_push(&ev_ring, &r) == FALSE) {
+        sched_yield();
+    }
+    return TRUE;
+}
+
+/*************************************************************************
+ * Event Log Decode Function.
+ *
+ * This function prints an event log to stdout, either as the text r_log
+ * would have had for its events, or as CSV with the columns
+ * event,time_ns,teller,customer,service_type,arrival_ns. A termination
+ * has the number served in customer and the start time in arrival_ns.
+ *
+ * @param path - The event log file.
+ * @param csv - TRUE for CSV, FALSE for text.
+ * @return int - 0 on success, 1 if the file is not an event log.
+ *************************************************************************/
+int evlog_decode(const char *path, int csv) {
+    static const char *names[EVLOG_TYPES] = {"arrival", "response", "completion", "termination", "balked",
+                                             "rejected", "reneged"};
+    evlog_header_t h;
+    evlog_record_t *batch;
+    FILE *f = fopen(path, "rb");
+    size_t n, i;
+
+    if (f == NULL) {
+        printf("Error: Failed to open the event log %s.\n", path);
+        return 1;
+    }
+    if (fread(&h, sizeof(evlog_header_t), 1, f) != 1 || memcmp(h.magic, EVLOG_MAGIC, sizeof(h.magic)) != 0
+        || h.record_size != (long) sizeof(evlog_record_t)) {
+        printf("Error: %s is not an event log.\n", path);
+        fclose(f);
+        return 1;
+    }
+    batch = malloc(sizeof(evlog_record_t) * EVLOG_BATCH);
+    if (batch == NULL) {
+        fclose(f);
+        return 1;
+    }
+
+    if (csv == TRUE) {
+        printf("event,time_ns,teller,customer,service_type,arrival_ns\n");
+    }
+    while ((n = fread(batch, sizeof(evlog_record_t), EVLOG_BATCH, f)) > 0) {
+        for (i = 0; i < n; i++) {
+            if (batch[i].type < 0 || batch[i].type >= EVLOG_TYPES) {
+                continue; /* Not an event this build knows. */
+            }
+            if (csv == TRUE) {
+                printf("%s,%ld,%d,%ld,%c,%ld\n", names[(int) batch[i].type], batch[i].time, batch[i].teller,
+                       batch[i].customer, batch[i].service_type == '\0' ? '-' : batch[i].service_type,
+                       batch[i].arrival);
+            } else {
+                print_text(&h, &batch[i]);
+            }
+        }
+    }
+
+    free(batch);
+    fclose(f);
+    return 0;
+}
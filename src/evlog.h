@@ -0,0 +1,79 @@
+#ifndef OS_ASSIGNMENT_20183622_EVLOG_H
+#define OS_ASSIGNMENT_20183622_EVLOG_H
+
+#include "standard.h"
+
+#define EVLOG_MAGIC "BANKEVT1" /* The first bytes of an event log file. */
+#define EVLOG_RING 65536 /* The number of records that can be waiting to be written. */
+#define EVLOG_BATCH 2048 /* The most records written with one write(), 64KB. */
+#define EVLOG_FLUSH_NS 100000000L /* Write a batch once its oldest record is this old (100ms). */
+
+#define EVLOG_ARRIVAL 0 /* A customer joined the queue. */
+#define EVLOG_RESPONSE 1 /* A teller took a customer. */
+#define EVLOG_COMPLETION 2 /* A teller finished with a customer. */
+#define EVLOG_TERMINATION 3 /* A teller stopped. */
+#define EVLOG_BALKED 4 /* A customer balked at a deep queue. */
+#define EVLOG_REJECTED 5 /* A customer was turned away by the token bucket. */
+#define EVLOG_RENEGED 6 /* A customer left the queue without being served. */
+#define EVLOG_TYPES 7 /* The number of event types. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for the header of an event log file.
+ *
+ * @param magic - EVLOG_MAGIC, without its terminator.
+ * @param record_size - The size of a record, to catch a log written by
+ *                      another build.
+ * @param clock_base_ns - The CLOCK_MONOTONIC time matching clock_base_day.
+ * @param clock_base_day - The local wall-clock time of day at clock_base_ns,
+ *                         in seconds, so the decoder prints the same times
+ *                         as the text log.
+ *************************************************************************/
+typedef struct evlog_header {
+    char magic[8];
+    long record_size;
+    long clock_base_ns;
+    long clock_base_day;
+} evlog_header_t; /* Event log header struct. */
+
+/*************************************************************************
+ * Struct for one event, 32 bytes.
+ *
+ * A termination keeps the number of customers served in customer and
+ * the teller's start time in arrival.
+ *
+ * @param time - The time of the event, in ns.
+ * @param customer - The customer number.
+ * @param arrival - The time the customer arrived in the queue, in ns.
+ * @param teller - The teller number, or 0 if no teller was involved.
+ * @param type - The event type (EVLOG_ARRIVAL to EVLOG_RENEGED).
+ * @param service_type - The service type of the customer.
+ *************************************************************************/
+typedef struct evlog_record {
+    long time;
+    long customer;
+    long arrival;
+    int teller;
+    char type;
+    char service_type;
+    char pad[2];
+} evlog_record_t; /* Event log record struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int evlog_open(const char *path, long clock_base_ns, long clock_base_day);
+
+int evlog_restart(void);
+
+void evlog_close(void);
+
+int evlog_write(int type, int teller, long customer, char service_type, long arrival, long time);
+
+int evlog_decode(const char *path, int csv);
+
+#endif /*OS_ASSIGNMENT_20183622_EVLOG_H*/
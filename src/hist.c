@@ -0,0 +1,191 @@
+#include "hist.h"
+
+/*************************************************************************
+ *                          Histogram Functions                          *
+ *************************************************************************/
+
+/*************************************************************************
+ * Bucket Index Function.
+ *
+ * @param value - The value, in nanoseconds.
+ * @return int - The bucket the value is counted in.
+ *************************************************************************/
+static int bucket_index(unsigned long value) {
+    int shift;
+
+    if (value < (2UL << HIST_SUB_BITS)) {
+        return (int) value;
+    }
+    if (value >= (1UL << HIST_MAX_BITS)) {
+        return HIST_BUCKETS - 1;
+    }
+
+    /* Keep the top HIST_SUB_BITS + 1 bits of the value. */
+    shift = (63 - __builtin_clzl(value)) - HIST_SUB_BITS;
+    return (shift << HIST_SUB_BITS) + (int) (value >> shift);
+}
+
+/*************************************************************************
+ * Bucket Upper Bound Function.
+ *
+ * @param index - The bucket index.
+ * @return unsigned long - The largest value counted in the bucket.
+ *************************************************************************/
+static unsigned long bucket_upper(int index) {
+    int shift;
+    unsigned long top;
+
+    if (index < (2 << HIST_SUB_BITS)) {
+        return (unsigned long) index;
+    }
+
+    shift = (index >> HIST_SUB_BITS) - 1;
+    top = (unsigned long) (index & ((1 << HIST_SUB_BITS) - 1)) + (1UL << HIST_SUB_BITS);
+    return ((top + 1) << shift) - 1;
+}
+
+/*************************************************************************
+ * Histogram Record Function.
+ *
+ * @param h - The histogram.
+ * @param value - The value to be recorded, in nanoseconds. Negative values
+ *                (from clock skew) are recorded as 0.
+ * @return void
+ *************************************************************************/
+void hist_record(hist_t *h, long value) {
+    unsigned long v = value < 0 ? 0 : (unsigned long) value;
+
+    h->buckets[bucket_index(v)]++;
+    h->count++;
+    h->sum += (double) v;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+/*************************************************************************
+ * Histogram Record Shared Function.
+ *
+ * This function records a value in a histogram that other threads or
+ * processes read while it is written. It must only be called by the one
+ * thread that writes the histogram, so each field is updated with a
+ * relaxed load and store instead of a locked read-modify-write, and a
+ * reader never sees a torn field.
+ *
+ * @param h - The histogram.
+ * @param value - The value to be recorded, in nanoseconds. Negative values
+ *                are recorded as 0.
+ * @return void
+ *************************************************************************/
+void hist_record_shared(hist_t *h, long value) {
+    unsigned long v = value < 0 ? 0 : (unsigned long) value;
+    unsigned int *bucket = &h->buckets[bucket_index(v)];
+    double sum = h->sum + (double) v;
+
+    __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+    __atomic_store(&h->sum, &sum, __ATOMIC_RELAXED);
+    if (v > h->max) {
+        __atomic_store_n(&h->max, v, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&h->count, h->count + 1, __ATOMIC_RELEASE);
+}
+
+/*************************************************************************
+ * Histogram Merge Function.
+ *
+ * @param dst - The histogram to add to.
+ * @param src - The histogram to be added.
+ * @return void
+ *************************************************************************/
+void hist_merge(hist_t *dst, const hist_t *src) {
+    int i; /* Loop counter. */
+
+    if (src->count == 0) {
+        return;
+    }
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/*************************************************************************
+ * Histogram Percentile Function.
+ *
+ * @param h - The histogram.
+ * @param p - The percentile, from 0 to 100.
+ * @return unsigned long - The largest value in the bucket holding the
+ *                         percentile, or 0 if the histogram is empty.
+ *************************************************************************/
+unsigned long hist_percentile(const hist_t *h, double p) {
+    unsigned long rank;
+    unsigned long seen = 0;
+    unsigned long upper;
+    int i; /* Loop counter. */
+
+    if (h->count == 0) {
+        return 0;
+    }
+
+    rank = (unsigned long) (p / 100.0 * (double) h->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            upper = bucket_upper(i);
+            return upper < h->max ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+/*************************************************************************
+ *                           Latency Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Latency Type Function.
+ *
+ * @param service_type - The service type of a customer.
+ * @return int - The index of the service type ('W' 0, 'D' 1, otherwise 2).
+ *************************************************************************/
+int latency_type(char service_type) {
+    if (service_type == 'W') {
+        return 0;
+    } else if (service_type == 'D') {
+        return 1;
+    }
+    return 2; /* service_type == 'I' */
+}
+
+/*************************************************************************
+ * Latency Record Function.
+ *
+ * This function records the queue wait, service time, end-to-end time and
+ * producer lag of a customer. The end-to-end time counts from when the
+ * customer was meant to arrive, so the time a late producer held the
+ * customer back is not lost (coordinated omission).
+ *
+ * @param l - The latencies of the teller that served the customer.
+ * @param service_type - The service type of the customer.
+ * @param intended - The time the customer was meant to arrive, in ns.
+ * @param arrival - The time the customer arrived in the queue, in ns.
+ * @param response - The time the teller took the customer, in ns.
+ * @param completion - The time the teller finished with the customer, in ns.
+ * @return void
+ *************************************************************************/
+void latency_record(latency_t *l, char service_type, long intended, long arrival, long response, long completion) {
+    int type = latency_type(service_type);
+
+    hist_record(&l->h[LAT_WAIT][type], response - arrival);
+    hist_record(&l->h[LAT_SERVICE][type], completion - response);
+    hist_record(&l->h[LAT_TOTAL][type], completion - intended);
+    hist_record(&l->h[LAT_LAG][type], arrival - intended);
+}
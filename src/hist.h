@@ -0,0 +1,66 @@
+#ifndef OS_ASSIGNMENT_20183622_HIST_H
+#define OS_ASSIGNMENT_20183622_HIST_H
+
+#include <stddef.h> /* For size_t. */
+
+#define HIST_SUB_BITS 5 /* Each power of two is split into 2^HIST_SUB_BITS buckets (about 3% precision). */
+#define HIST_MAX_BITS 48 /* Values are recorded up to 2^48 ns (about 78 hours). */
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) << HIST_SUB_BITS)
+
+#define LAT_WAIT 0 /* Queue wait: arrival to response. */
+#define LAT_SERVICE 1 /* Service: response to completion. */
+#define LAT_TOTAL 2 /* End to end: intended arrival to completion. */
+#define LAT_LAG 3 /* Producer lag: intended arrival to arrival in the queue. */
+#define LAT_METRICS 4 /* The number of latency metrics. */
+#define LAT_TYPES 3 /* The number of service types ('W', 'D' and 'I'). */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a latency histogram.
+ *
+ * Values below 2^(HIST_SUB_BITS + 1) have a bucket each. Above that every
+ * power of two is split into 2^HIST_SUB_BITS equal buckets, so a bucket
+ * is never wider than about 3% of the values in it, as in an HDR
+ * histogram.
+ *
+ * @param count - The number of values recorded.
+ * @param max - The largest value recorded.
+ * @param sum - The sum of the values recorded, for the mean.
+ * @param buckets - The number of values recorded in each bucket.
+ *************************************************************************/
+typedef struct hist {
+    unsigned long count;
+    unsigned long max;
+    double sum;
+    unsigned int buckets[HIST_BUCKETS];
+} hist_t; /* Histogram struct. */
+
+/*************************************************************************
+ * Struct for the latencies recorded by one teller.
+ *
+ * @param h - A histogram for each latency metric and service type.
+ *************************************************************************/
+typedef struct latency {
+    hist_t h[LAT_METRICS][LAT_TYPES];
+} latency_t; /* Latency struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+void hist_record(hist_t *h, long value);
+
+void hist_record_shared(hist_t *h, long value);
+
+void hist_merge(hist_t *dst, const hist_t *src);
+
+unsigned long hist_percentile(const hist_t *h, double p);
+
+int latency_type(char service_type);
+
+void latency_record(latency_t *l, char service_type, long intended, long arrival, long response, long completion);
+
+#endif /*OS_ASSIGNMENT_20183622_HIST_H*/
@@ -0,0 +1,255 @@
+#include "ingest.h"
+#include <fcntl.h> /* For open() */
+#include <sys/mman.h> /* For mmap() */
+#include <sys/stat.h> /* For fstat() */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Is Blank Function.
+ *
+ * @param ch - The character to be checked.
+ * @return int - TRUE if the character separates columns, FALSE otherwise.
+ *************************************************************************/
+static int is_blank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+/*************************************************************************
+ * Is Digit Function.
+ *
+ * @param ch - The character to be checked.
+ * @return int - TRUE if the character is a decimal digit, FALSE otherwise.
+ *************************************************************************/
+static int is_digit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+/*************************************************************************
+ * Skip Line Function.
+ *
+ * This function moves the reader past the end of the current line.
+ *
+ * @param in - The customer file reader.
+ * @return void
+ *************************************************************************/
+static void skip_line(ingest_t *in) {
+    const char *nl = memchr(in->data + in->pos, '\n', in->end - in->pos);
+
+    in->pos = (nl == NULL) ? in->end : (size_t) (nl - in->data) + 1;
+}
+
+/*************************************************************************
+ * Line Start Function.
+ *
+ * @param in - The customer file reader.
+ * @param offset - An offset in the customer file.
+ * @return size_t - The offset of the first line that starts at or after
+ *                  the given offset, or the size of the file.
+ *************************************************************************/
+static size_t line_start(const ingest_t *in, size_t offset) {
+    const char *nl;
+
+    if (offset == 0 || offset >= in->size || in->data[offset - 1] == '\n') {
+        return offset;
+    }
+
+    nl = memchr(in->data + offset, '\n', in->size - offset);
+    return (nl == NULL) ? in->size : (size_t) (nl - in->data) + 1;
+}
+
+/*************************************************************************
+ *                           Ingest Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Ingest Open Function.
+ *
+ * This function memory-maps the customer file for reading.
+ *
+ * @param in - The customer file reader to be initialized.
+ * @param filename - The name of the customer file.
+ * @return int - 0 on success, 1 if the file could not be opened.
+ *************************************************************************/
+int ingest_open(ingest_t *in, const char *filename) {
+    struct stat st;
+    void *data;
+    int fd;
+
+    memset(in, 0, sizeof(ingest_t));
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 1;
+    }
+
+    /* An empty file cannot be mapped, and has no customers anyway. */
+    if (st.st_size > 0) {
+        data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return 1;
+        }
+        posix_madvise(data, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL);
+        in->data = data;
+        in->size = (size_t) st.st_size;
+        in->end = in->size;
+    }
+
+    close(fd); /* The mapping stays valid after the file is closed. */
+    return 0;
+}
+
+/*************************************************************************
+ * Ingest Shard Function.
+ *
+ * This function limits a reader to one of several equal byte ranges of
+ * the customer file. Both ends of the range are moved forward to the
+ * start of a line, so every line is read by exactly one shard.
+ *
+ * @param in - The customer file reader, just opened.
+ * @param shard - The index of the shard, from 0 to shards - 1.
+ * @param shards - The number of shards.
+ * @return void
+ *************************************************************************/
+void ingest_shard(ingest_t *in, int shard, int shards) {
+    in->shard = shard;
+    in->pos = line_start(in, in->size / shards * shard);
+    in->end = (shard == shards - 1) ? in->size : line_start(in, in->size / shards * (shard + 1));
+}
+
+/*************************************************************************
+ * Ingest Next Function.
+ *
+ * This function scans the next customer from the customer file. Lines
+ * that do not start with a customer number and a service type are
+ * skipped.
+ *
+ * @param in - The customer file reader.
+ * @param c - The customer to be filled with the number and service type.
+ * @param at - Filled with the arrival time in nanoseconds from the start
+ *             of the run, or -1 if the line has no arrival time.
+ * @return int - TRUE if a customer was read, FALSE at the end of the file.
+ *************************************************************************/
+int ingest_next(ingest_t *in, customer_t *c, long *at) {
+    const char *p = in->data;
+    size_t end = in->end;
+    unsigned long number;
+    long seconds;
+    long frac;
+    long scale;
+
+    while (in->pos < end) {
+        /* Skip the blank space and empty lines before the customer number. */
+        while (in->pos < end && (is_blank(p[in->pos]) || p[in->pos] == '\n')) {
+            in->pos++;
+        }
+        if (in->pos == end || !is_digit(p[in->pos])) {
+            if (in->pos < end) {
+                skip_line(in);
+            }
+            continue;
+        }
+
+        /* The customer number. */
+        number = 0;
+        while (in->pos < end && is_digit(p[in->pos])) {
+            number = number * 10 + (unsigned long) (p[in->pos++] - '0');
+        }
+
+        /* The service type. */
+        while (in->pos < end && is_blank(p[in->pos])) {
+            in->pos++;
+        }
+        if (in->pos == end || p[in->pos] == '\n') {
+            continue; /* There is no service type, so skip the line. */
+        }
+        c->customer_number = (long) number;
+        c->service_type = p[in->pos++];
+
+        /* The optional arrival time, in seconds with an optional fraction. */
+        *at = -1;
+        while (in->pos < end && is_blank(p[in->pos])) {
+            in->pos++;
+        }
+        if (in->pos < end && is_digit(p[in->pos])) {
+            seconds = 0;
+            while (in->pos < end && is_digit(p[in->pos])) {
+                seconds = seconds * 10 + (p[in->pos++] - '0');
+            }
+            frac = 0;
+            scale = 1000000000L;
+            if (in->pos < end && p[in->pos] == '.') {
+                in->pos++;
+                while (in->pos < end && is_digit(p[in->pos])) {
+                    if (scale > 1) {
+                        scale /= 10;
+                        frac += (p[in->pos] - '0') * scale;
+                    }
+                    in->pos++;
+                }
+            }
+            *at = seconds * 1000000000L + frac;
+        }
+
+        if (in->pos < end) {
+            skip_line(in);
+        }
+        in->index++;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*************************************************************************
+ * Ingest Count Function.
+ *
+ * This function reads the customer file once, shard by shard, and counts
+ * the customers before each shard, so a shard can number its customers
+ * from where the one before it ends.
+ *
+ * @param filename - The name of the customer file.
+ * @param shards - The number of shards.
+ * @param first - Filled with the number of customers before each shard.
+ * @return int - 0 on success, 1 if the file could not be opened.
+ *************************************************************************/
+int ingest_count(const char *filename, int shards, long *first) {
+    ingest_t in;
+    customer_t c;
+    long at;
+    int shard;
+
+    if (ingest_open(&in, filename) != 0) {
+        return 1;
+    }
+    for (shard = 0; shard < shards; shard++) {
+        first[shard] = in.index;
+        ingest_shard(&in, shard, shards);
+        while (ingest_next(&in, &c, &at) == TRUE) {
+            /* Count the customers of this shard. */
+        }
+    }
+    ingest_close(&in);
+    return 0;
+}
+
+/*************************************************************************
+ * Ingest Close Function.
+ *
+ * @param in - The customer file reader.
+ * @return void
+ *************************************************************************/
+void ingest_close(ingest_t *in) {
+    if (in->data != NULL) {
+        munmap((void *) in->data, in->size);
+    }
+    in->data = NULL;
+}
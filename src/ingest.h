@@ -0,0 +1,49 @@
+#ifndef OS_ASSIGNMENT_20183622_INGEST_H
+#define OS_ASSIGNMENT_20183622_INGEST_H
+
+#include "standard.h"
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a customer file reader.
+ *
+ * The customer file is memory-mapped and scanned in place, so reading a
+ * customer costs no system call and no copy, however large the file is.
+ * Each line holds a customer number, a service type and, optionally, the
+ * arrival time in seconds from the start of the run (e.g. "12 W 3.25").
+ * A reader can be limited to a shard of the file with ingest_shard().
+ *
+ * @param data - The mapped customer file.
+ * @param size - The size of the customer file, in bytes.
+ * @param pos - The offset of the next byte to be scanned.
+ * @param end - The offset the reader stops at, the start of the next shard.
+ * @param shard - The index of the shard the reader is limited to, or 0.
+ * @param index - The number of customers read so far.
+ *************************************************************************/
+typedef struct ingest {
+    const char *data;
+    size_t size;
+    size_t pos;
+    size_t end;
+    int shard;
+    long index;
+} ingest_t; /* Customer file reader struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int ingest_open(ingest_t *in, const char *filename);
+
+void ingest_shard(ingest_t *in, int shard, int shards);
+
+int ingest_next(ingest_t *in, customer_t *c, long *at);
+
+int ingest_count(const char *filename, int shards, long *first);
+
+void ingest_close(ingest_t *in);
+
+#endif /*OS_ASSIGNMENT_20183622_INGEST_H*/
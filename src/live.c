@@ -0,0 +1,309 @@
+#include "live.h"
+#include "standard.h"
+#include "shm.h"
+#include <errno.h> /* For ESRCH */
+
+/*************************************************************************
+ *                            Global Variables                           *
+ *************************************************************************/
+
+static shm_t live_shm; /* The published segment. */
+static live_t *live = NULL; /* The head of the published segment, or NULL if the stats are not published. */
+static live_teller_t *live_slots; /* The teller slots, after the head. */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Print Latency Function.
+ *
+ * @param name - The name of the latency.
+ * @param h - The histogram, merged across the tellers.
+ * @return void
+ *************************************************************************/
+static void print_latency(const char *name, const hist_t *h) {
+    printf("  %-6s p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f\n", name, hist_percentile(h, 50.0) / 1e6,
+           hist_percentile(h, 90.0) / 1e6, hist_percentile(h, 99.0) / 1e6, hist_percentile(h, 99.9) / 1e6,
+           h->max / 1e6);
+}
+
+/*************************************************************************
+ * Print Snapshot Function.
+ *
+ * This function prints the queue depth, the arrival and service rates
+ * since the last snapshot and over the whole run, the latency percentiles
+ * in milliseconds, and each teller's count and busy fraction.
+ *
+ * @param l - The head of the segment.
+ * @param state - The state of the run.
+ * @param now - The time of the snapshot, in ns.
+ * @param last - The time of the last snapshot, in ns, or 0 for the first.
+ * @param arrived - The arrivals at the last snapshot, updated.
+ * @param served - The customers served at the last snapshot, updated.
+ * @param wait - Scratch space for the merged queue waits.
+ * @param total - Scratch space for the merged end-to-end times.
+ * @return void
+ *************************************************************************/
+static void print_snapshot(const live_t *l, int state, long now, long last, unsigned long *arrived, unsigned long *served,
+                           hist_t *wait, hist_t *total) {
+    static const char *states[] = {"running", "done", "interrupted"};
+    const live_teller_t *slots = (const live_teller_t *) (l + 1);
+    unsigned long arrivals = __atomic_load_n(&l->arrivals, __ATOMIC_RELAXED);
+    unsigned long n = 0; /* The customers served. */
+    double elapsed = (now - l->start_time) / 1e9; /* The length of the run, in seconds. */
+    double period = last > 0 ? (now - last) / 1e9 : elapsed; /* The time since the last snapshot, in seconds. */
+    int i; /* Loop counter. */
+
+    memset(wait, 0, sizeof(hist_t));
+    memset(total, 0, sizeof(hist_t));
+    for (i = 0; i < l->slots; i++) {
+        n += __atomic_load_n(&slots[i].served, __ATOMIC_RELAXED);
+        hist_merge(wait, &slots[i].wait);
+        hist_merge(total, &slots[i].total);
+    }
+
+    printf("\n[%.1fs] pid %ld, %s\n", elapsed, l->pid, states[state]);
+    printf("  Queue  %d/%d\n", __atomic_load_n(&l->depth, __ATOMIC_RELAXED), l->queue_size);
+    printf("  Arrive %lu (%.1f/s now, %.1f/s mean)\n", arrivals, period > 0 ? (arrivals - *arrived) / period : 0.0,
+           elapsed > 0 ? arrivals / elapsed : 0.0);
+    printf("  Served %lu (%.1f/s now, %.1f/s mean)\n", n, period > 0 ? (n - *served) / period : 0.0,
+           elapsed > 0 ? n / elapsed : 0.0);
+    printf("Latency (ms)\n");
+    print_latency("Wait", wait);
+    print_latency("Total", total);
+    printf("Teller   Served  Busy\n");
+    for (i = 0; i < l->slots; i++) {
+        if (__atomic_load_n(&slots[i].teller_number, __ATOMIC_ACQUIRE) == 0) {
+            continue;
+        }
+        printf("  %-6d %6lu %5.1f%%%s\n", slots[i].teller_number, __atomic_load_n(&slots[i].served, __ATOMIC_RELAXED),
+               now > slots[i].start_time ? 100.0 * __atomic_load_n(&slots[i].busy_ns, __ATOMIC_RELAXED)
+                                           / (now - slots[i].start_time) : 0.0,
+               __atomic_load_n(&slots[i].active, __ATOMIC_RELAXED) == TRUE ? "" : " (retired)");
+    }
+    fflush(stdout);
+
+    *arrived = arrivals;
+    *served = n;
+}
+
+/*************************************************************************
+ *                        Live Statistics Functions                      *
+ *************************************************************************/
+
+/*************************************************************************
+ * Live Open Function.
+ *
+ * This function publishes the live statistics of the run in a shared
+ * memory segment, which live_watch() reads from another process. It must
+ * be called before any teller process is forked, so they share it.
+ *
+ * @param name - The name of the segment.
+ * @param slots - The number of teller slots.
+ * @param queue_size - The size of the customer queue (m).
+ * @param start - The time the run started, in ns.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int live_open(const char *name, int slots, int queue_size, long start) {
+    live_t *l;
+
+    if (shm_publish(&live_shm, name, sizeof(live_t) + sizeof(live_teller_t) * slots) != 0) {
+        return 1;
+    }
+    l = (live_t *) live_shm.base;
+    l->pid = (long) getpid();
+    l->slots = slots;
+    l->queue_size = queue_size;
+    l->start_time = start;
+    l->state = LIVE_RUNNING;
+    live_slots = (live_teller_t *) (l + 1);
+    __atomic_store_n(&l->magic, LIVE_MAGIC, __ATOMIC_RELEASE);
+    live = l;
+    return 0;
+}
+
+/*************************************************************************
+ * Live Close Function.
+ *
+ * This function marks the run as done and removes the segment's name. A
+ * monitor that is attached still reads the final numbers.
+ *
+ * @return void
+ *************************************************************************/
+void live_close(void) {
+    if (live == NULL) {
+        return;
+    }
+    __atomic_store_n(&live->end_time, now_ns(), __ATOMIC_RELAXED);
+    __atomic_store_n(&live->state, LIVE_DONE, __ATOMIC_RELEASE);
+    shm_remove(&live_shm);
+    live = NULL;
+    shm_destroy(&live_shm);
+}
+
+/*************************************************************************
+ * Live Interrupt Function.
+ *
+ * This function marks the run as interrupted. It is called from the
+ * SIGINT handler, so it only stores, and it keeps the segment's name so
+ * the counts can still be read once the program has exited. The monitor
+ * removes it.
+ *
+ * @return void
+ *************************************************************************/
+void live_interrupt(void) {
+    if (live == NULL) {
+        return;
+    }
+    __atomic_store_n(&live->end_time, now_ns(), __ATOMIC_RELAXED);
+    __atomic_store_n(&live->state, LIVE_STOPPED, __ATOMIC_RELEASE);
+}
+
+/*************************************************************************
+ * Live Teller Function.
+ *
+ * This function shows a teller in its slot, when it starts or is started
+ * again by the autoscaler.
+ *
+ * @param slot - The teller slot.
+ * @param teller_number - The teller number.
+ * @param start - The time the teller first started, in ns.
+ * @return void
+ *************************************************************************/
+void live_teller(int slot, int teller_number, long start) {
+    if (live == NULL) {
+        return;
+    }
+    live_slots[slot].start_time = start;
+    __atomic_store_n(&live_slots[slot].active, TRUE, __ATOMIC_RELAXED);
+    __atomic_store_n(&live_slots[slot].teller_number, teller_number, __ATOMIC_RELEASE);
+}
+
+/*************************************************************************
+ * Live Retire Function.
+ *
+ * @param slot - The teller slot whose teller has stopped.
+ * @return void
+ *************************************************************************/
+void live_retire(int slot) {
+    if (live == NULL) {
+        return;
+    }
+    __atomic_store_n(&live_slots[slot].active, FALSE, __ATOMIC_RELAXED);
+}
+
+/*************************************************************************
+ * Live Arrivals Function.
+ *
+ * @param n - The number of customers a producer just added to the queue.
+ * @param depth - The number of customers in the queue after they were added.
+ * @return void
+ *************************************************************************/
+void live_arrivals(int n, int depth) {
+    if (live == NULL) {
+        return;
+    }
+    __atomic_add_fetch(&live->arrivals, (unsigned long) n, __ATOMIC_RELAXED);
+    __atomic_store_n(&live->depth, depth, __ATOMIC_RELAXED);
+}
+
+/*************************************************************************
+ * Live Depth Function.
+ *
+ * @param depth - The number of customers in the queue after a teller took some.
+ * @return void
+ *************************************************************************/
+void live_depth(int depth) {
+    if (live == NULL) {
+        return;
+    }
+    __atomic_store_n(&live->depth, depth, __ATOMIC_RELAXED);
+}
+
+/*************************************************************************
+ * Live Served Function.
+ *
+ * This function counts a customer served in its teller's slot. Only the
+ * thread serving the slot's teller calls it, so the updates are plain
+ * relaxed stores.
+ *
+ * @param slot - The teller slot.
+ * @param intended - The time the customer was meant to arrive, in ns.
+ * @param arrival - The time the customer arrived in the queue, in ns.
+ * @param response - The time the teller took the customer, in ns.
+ * @param completion - The time the teller finished with the customer, in ns.
+ * @return void
+ *************************************************************************/
+void live_served(int slot, long intended, long arrival, long response, long completion) {
+    live_teller_t *s;
+
+    if (live == NULL) {
+        return;
+    }
+    s = &live_slots[slot];
+    hist_record_shared(&s->wait, response - arrival);
+    hist_record_shared(&s->total, completion - intended);
+    __atomic_store_n(&s->busy_ns, s->busy_ns + (unsigned long) (completion - response), __ATOMIC_RELAXED);
+    __atomic_store_n(&s->served, s->served + 1, __ATOMIC_RELAXED);
+}
+
+/*************************************************************************
+ * Live Watch Function.
+ *
+ * This function attaches to the statistics a run publishes under name
+ * and prints a snapshot every LIVE_PERIOD_MS until the run finishes, is
+ * interrupted or its process is gone. The last snapshot has the final
+ * counts. The segment of a run that did not finish cleanly is removed.
+ *
+ * @param name - The name the run published its statistics under.
+ * @return int - 0 on success, 1 if the statistics could not be read.
+ *************************************************************************/
+int live_watch(const char *name) {
+    struct timespec period = {LIVE_PERIOD_MS / 1000, (LIVE_PERIOD_MS % 1000) * 1000000L};
+    shm_t s;
+    const live_t *l;
+    hist_t *wait = malloc(sizeof(hist_t));
+    hist_t *total = malloc(sizeof(hist_t));
+    unsigned long arrived = 0, served = 0; /* The counts at the last snapshot. */
+    long last = 0; /* The time of the last snapshot. */
+    long now;
+    int state;
+
+    if (wait == NULL || total == NULL || shm_attach(&s, name) != 0) {
+        free(wait);
+        free(total);
+        return 1;
+    }
+    l = (const live_t *) s.base;
+    if (s.size < sizeof(live_t) || __atomic_load_n(&l->magic, __ATOMIC_ACQUIRE) != LIVE_MAGIC
+        || s.size < sizeof(live_t) + sizeof(live_teller_t) * l->slots) {
+        printf("Error: %s does not hold live statistics.\n", s.name);
+        shm_destroy(&s);
+        free(wait);
+        free(total);
+        return 1;
+    }
+
+    for (;;) {
+        state = __atomic_load_n(&l->state, __ATOMIC_ACQUIRE);
+        if (state == LIVE_RUNNING && kill((pid_t) l->pid, 0) != 0 && errno == ESRCH) {
+            state = LIVE_STOPPED; /* The run died without saying so. */
+        }
+        now = state == LIVE_RUNNING || l->end_time == 0 ? now_ns() : l->end_time;
+        print_snapshot(l, state, now, last, &arrived, &served, wait, total);
+        if (state != LIVE_RUNNING) {
+            break;
+        }
+        last = now;
+        nanosleep(&period, NULL);
+    }
+
+    if (state == LIVE_STOPPED) {
+        shm_remove(&s);
+    }
+    shm_destroy(&s);
+    free(wait);
+    free(total);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#ifndef OS_ASSIGNMENT_20183622_LIVE_H
+#define OS_ASSIGNMENT_20183622_LIVE_H
+
+#include "hist.h"
+
+#define LIVE_MAGIC 0x4c495645 /* "LIVE", so the monitor does not read some other segment. */
+#define LIVE_PERIOD_MS 1000 /* How often the monitor prints a snapshot. */
+
+#define LIVE_RUNNING 0 /* The run is in progress. */
+#define LIVE_DONE 1 /* The run finished. */
+#define LIVE_STOPPED 2 /* The run was interrupted with CTRL+C. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for the live statistics of one teller slot.
+ *
+ * A slot is only written by the thread serving its teller, so every
+ * field is updated with plain relaxed stores, without a lock or a
+ * read-modify-write. A reader may see a customer counted in one field
+ * and not yet in another, which a snapshot can live with.
+ *
+ * @param teller_number - The teller number, or 0 if the slot was never used.
+ * @param active - TRUE while the teller is serving or waiting for customers.
+ * @param start_time - The CLOCK_MONOTONIC time the teller started, in ns.
+ * @param served - The number of customers served.
+ * @param busy_ns - The time spent serving customers, in ns.
+ * @param wait - The queue waits (arrival to response).
+ * @param total - The end-to-end times (intended arrival to completion).
+ *************************************************************************/
+typedef struct live_teller {
+    int teller_number;
+    int active;
+    long start_time;
+    unsigned long served;
+    unsigned long busy_ns;
+    hist_t wait;
+    hist_t total;
+} live_teller_t; /* Live teller struct. */
+
+/*************************************************************************
+ * Struct for the live statistics of a run.
+ *
+ * It is the head of the published segment, and the teller slots follow
+ * it.
+ *
+ * @param magic - LIVE_MAGIC.
+ * @param state - LIVE_RUNNING, LIVE_DONE or LIVE_STOPPED.
+ * @param pid - The process running the producers.
+ * @param slots - The number of teller slots after the head.
+ * @param queue_size - The size of the customer queue (m).
+ * @param depth - The number of customers in the queue when last sampled.
+ * @param start_time - The CLOCK_MONOTONIC time the run started, in ns.
+ * @param end_time - The CLOCK_MONOTONIC time the run finished or was
+ *                   interrupted, in ns, or 0 while it is running.
+ * @param arrivals - The number of customers added to the queue.
+ *************************************************************************/
+typedef struct live {
+    int magic;
+    int state;
+    long pid;
+    int slots;
+    int queue_size;
+    int depth;
+    long start_time;
+    long end_time;
+    unsigned long arrivals;
+} live_t; /* Live statistics struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int live_open(const char *name, int slots, int queue_size, long start);
+
+void live_close(void);
+
+void live_interrupt(void);
+
+void live_teller(int slot, int teller_number, long start);
+
+void live_retire(int slot);
+
+void live_arrivals(int n, int depth);
+
+void live_depth(int depth);
+
+void live_served(int slot, long intended, long arrival, long response, long completion);
+
+int live_watch(const char *name);
+
+#endif /*OS_ASSIGNMENT_20183622_LIVE_H*/
@@ -0,0 +1,242 @@
+#include "logger.h"
+#include <sched.h> /* For sched_yield() */
+#include <sys/uio.h> /* For writev() */
+#include <errno.h>
+
+/*************************************************************************
+ *                            Global Variables                           *
+ *************************************************************************/
+
+static ring_t log_ring; /* The log entries waiting to be written. */
+static log_entry_t *log_batch; /* The log entries collected for the next writev(). */
+static pthread_t log_thread; /* The logger thread. */
+static int log_fd = -1; /* The file descriptor of the log file. */
+static int log_running = FALSE; /* TRUE while the logger thread is accepting entries. */
+static int log_stop = FALSE; /* Set to TRUE to make the logger thread drain and exit. */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Write Batch Function.
+ *
+ * This function writes a batch of log entries with as few writev() calls
+ * as possible, picking up where a short write stopped.
+ *
+ * @param batch - The log entries to be written.
+ * @param n - The number of log entries in the batch.
+ * @return void
+ *************************************************************************/
+static void write_batch(log_entry_t *batch, int n) {
+    struct iovec iov[LOG_BATCH];
+    struct iovec *next = iov;
+    ssize_t written;
+    int i; /* Loop counter. */
+
+    for (i = 0; i < n; i++) {
+        iov[i].iov_base = batch[i].text;
+        iov[i].iov_len = batch[i].len;
+    }
+
+    while (n > 0) {
+        written = writev(log_fd, next, n);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error writing log file.\n");
+            return;
+        }
+
+        /* Skip the entries that were written in full. */
+        while (n > 0 && (size_t) written >= next->iov_len) {
+            written -= next->iov_len;
+            next++;
+            n--;
+        }
+        if (n > 0) {
+            next->iov_base = (char *) next->iov_base + written;
+            next->iov_len -= written;
+        }
+    }
+}
+
+/*************************************************************************
+ *                           Thread Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Logger Thread Function.
+ *
+ * This function collects log entries from the log ring into log_batch
+ * and writes them in batches. A batch is written when it is full, when
+ * it holds LOG_FLUSH_BYTES, or when it has waited LOG_FLUSH_NS. Once
+ * log_stop is set the ring is drained before the thread exits.
+ *
+ * @param arg - Unused.
+ * @return void* - NULL.
+ *************************************************************************/
+static void *logger(void *arg) {
+    log_entry_t *batch = log_batch;
+    struct timespec idle = {0, 1000000}; /* Sleep 1ms when there is nothing to write. */
+    long first = 0; /* The time the oldest entry in the batch was collected. */
+    int bytes = 0; /* The number of bytes in the batch. */
+    int n = 0; /* The number of entries in the batch. */
+    int stop;
+
+    (void) arg;
+
+    for (;;) {
+        stop = __atomic_load_n(&log_stop, __ATOMIC_ACQUIRE);
+
+        if (ring_pop(&log_ring, &batch[n]) == TRUE) {
+            if (n == 0) {
+                first = now_ns();
+            }
+            bytes += batch[n].len;
+            n++;
+
+            if (n == LOG_BATCH || bytes >= LOG_FLUSH_BYTES) {
+                write_batch(batch, n);
+                n = 0;
+                bytes = 0;
+            }
+            continue;
+        }
+
+        /* The ring is empty. */
+        if (n > 0 && (stop == TRUE || now_ns() - first >= LOG_FLUSH_NS)) {
+            write_batch(batch, n);
+            n = 0;
+            bytes = 0;
+        }
+
+        if (stop == TRUE) {
+            break; /* The ring was drained after log_stop was seen. */
+        }
+        nanosleep(&idle, NULL);
+    }
+
+    return NULL;
+}
+
+/*************************************************************************
+ *                            Logger Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Logger Start Function.
+ *
+ * This function starts the logger thread. From then on wrt_log() only
+ * copies its message into the log ring, and the disk writes happen on the
+ * logger thread.
+ *
+ * @param file - The open log file.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int logger_start(FILE *file) {
+    fflush(file);
+    log_fd = fileno(file);
+    log_stop = FALSE;
+
+    if (ring_init(&log_ring, LOG_RING, sizeof(log_entry_t)) != 0) {
+        printf("Error: Failed to allocate the log ring.\n");
+        return 1;
+    }
+
+    log_batch = malloc(sizeof(log_entry_t) * LOG_BATCH);
+    if (log_batch == NULL) {
+        printf("Error: Failed to allocate the log batch.\n");
+        ring_destroy(&log_ring);
+        return 1;
+    }
+
+    if (pthread_create(&log_thread, NULL, logger, NULL) != 0) {
+        printf("Error: Failed to create the logger thread.\n");
+        free(log_batch);
+        log_batch = NULL;
+        ring_destroy(&log_ring);
+        return 1;
+    }
+
+    __atomic_store_n(&log_running, TRUE, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/*************************************************************************
+ * Logger Restart Function.
+ *
+ * This function starts a new logger thread in a child process. fork()
+ * does not copy the parent's logger thread, and the entries still in the
+ * copied log ring and batch are the parent's to write, so the child drops
+ * them and starts with an empty ring. Both processes then write to the
+ * same open log file, whose offset they share, and each writev() lands
+ * whole.
+ *
+ * @param file - The open log file.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int logger_restart(FILE *file) {
+    if (__atomic_load_n(&log_running, __ATOMIC_ACQUIRE) == TRUE) {
+        ring_destroy(&log_ring);
+        free(log_batch);
+        log_batch = NULL;
+        __atomic_store_n(&log_running, FALSE, __ATOMIC_RELEASE);
+    }
+    return logger_start(file);
+}
+
+/*************************************************************************
+ * Logger Stop Function.
+ *
+ * This function writes every entry still in the log ring and stops the
+ * logger thread. It must be called once the other threads have stopped
+ * logging.
+ *
+ * @return void
+ *************************************************************************/
+void logger_stop(void) {
+    if (__atomic_load_n(&log_running, __ATOMIC_ACQUIRE) == FALSE) {
+        return;
+    }
+
+    __atomic_store_n(&log_running, FALSE, __ATOMIC_RELEASE);
+    __atomic_store_n(&log_stop, TRUE, __ATOMIC_RELEASE);
+    pthread_join(log_thread, NULL);
+    ring_destroy(&log_ring);
+    free(log_batch);
+    log_batch = NULL;
+}
+
+/*************************************************************************
+ * Logger Write Function.
+ *
+ * This function copies a message into the log ring. If the ring is full
+ * the caller yields until the logger thread has made room.
+ *
+ * @param msg - The message to be written to the log file.
+ * @return int - TRUE if the message was queued, FALSE if the logger thread
+ *               is not running.
+ *************************************************************************/
+int logger_write(const char *msg) {
+    log_entry_t entry;
+    size_t len = strlen(msg);
+
+    if (__atomic_load_n(&log_running, __ATOMIC_ACQUIRE) == FALSE) {
+        return FALSE;
+    }
+
+    if (len > LOG_LINE - 1) {
+        len = LOG_LINE - 1; /* Longer messages are truncated. */
+    }
+    memcpy(entry.text, msg, len);
+    entry.text[len] = '\n';
+    entry.len = (int) len + 1;
+
+    while (ring_push(&log_ring, &entry) == FALSE) {
+        sched_yield();
+    }
+
+    return TRUE;
+}
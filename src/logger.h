@@ -0,0 +1,39 @@
+#ifndef OS_ASSIGNMENT_20183622_LOGGER_H
+#define OS_ASSIGNMENT_20183622_LOGGER_H
+
+#include "standard.h"
+
+#define LOG_LINE (MSG_LEN + 1) /* The size of one log entry, with room for the newline. */
+#define LOG_RING 8192 /* The number of log entries that can be waiting to be written. */
+#define LOG_BATCH 256 /* The most log entries written with one writev(). */
+#define LOG_FLUSH_BYTES 65536 /* Write a batch once it holds this many bytes. */
+#define LOG_FLUSH_NS 100000000L /* Write a batch once its oldest entry is this old (100ms). */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a log entry.
+ *
+ * @param len - The length of the text, including the newline.
+ * @param text - The text to be written to the log file.
+ *************************************************************************/
+typedef struct log_entry {
+    int len;
+    char text[LOG_LINE];
+} log_entry_t; /* Log entry struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int logger_start(FILE *file);
+
+int logger_restart(FILE *file);
+
+void logger_stop(void);
+
+int logger_write(const char *msg);
+
+#endif /*OS_ASSIGNMENT_20183622_LOGGER_H*/
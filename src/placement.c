@@ -0,0 +1,338 @@
+/* Expose the Linux CPU affinity interfaces (cpu_set_t, sched_getcpu()). */
+#define _GNU_SOURCE
+
+#include "placement.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Parse List Function.
+ *
+ * This function reads a list of numbers and ranges in the format Linux
+ * uses for CPU and node lists, e.g. "0-3,8,10-11".
+ *
+ * @param s - The list.
+ * @param out - Filled with the numbers, in order.
+ * @param max - The most numbers out can hold. Numbers must be below max.
+ * @return int - The number of numbers read, or -1 if the list is not valid.
+ *************************************************************************/
+static int parse_list(const char *s, int *out, int max) {
+    char *end; /* The end of the number just read. */
+    long first, last; /* The bounds of a range. */
+    int n = 0;
+
+    while (*s != '\0' && *s != '\n') {
+        first = strtol(s, &end, 10);
+        if (end == s || first < 0) {
+            return -1;
+        }
+        last = first;
+        s = end;
+        if (*s == '-') {
+            s++;
+            last = strtol(s, &end, 10);
+            if (end == s || last < first) {
+                return -1;
+            }
+            s = end;
+        }
+        if (last >= max || n + (last - first + 1) > max) {
+            return -1;
+        }
+        for (; first <= last; first++) {
+            out[n++] = (int) first;
+        }
+        if (*s == ',') {
+            s++;
+        } else if (*s != '\0' && *s != '\n') {
+            return -1;
+        }
+    }
+    return n;
+}
+
+/*************************************************************************
+ * Read List Function.
+ *
+ * @param path - The sysfs file holding a CPU or node list.
+ * @param out - Filled with the numbers in the list.
+ * @return int - The number of numbers read, or -1 if the file could not be read.
+ *************************************************************************/
+static int read_list(const char *path, int *out) {
+    char line[4096];
+    FILE *f = fopen(path, "r");
+
+    if (f == NULL) {
+        return -1;
+    }
+    if (fgets(line, sizeof(line), f) == NULL) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return parse_list(line, out, PLACE_MAX_CPUS);
+}
+
+/*************************************************************************
+ * Read Topology Function.
+ *
+ * This function finds the NUMA node of every CPU. A machine without NUMA
+ * has every CPU on node 0.
+ *
+ * @param p - The placement, whose node array is filled.
+ * @return void
+ *************************************************************************/
+static void read_topology(placement_t *p) {
+    char path[256];
+    int *nodes = malloc(sizeof(int) * PLACE_MAX_CPUS);
+    int *cpus = malloc(sizeof(int) * PLACE_MAX_CPUS);
+    int n_nodes, n_cpus;
+    int i, j; /* Loop counters. */
+
+    memset(p->node, 0, sizeof(p->node));
+    if (nodes == NULL || cpus == NULL) {
+        free(nodes);
+        free(cpus);
+        return;
+    }
+
+    n_nodes = read_list(PLACE_NODE_DIR "/online", nodes);
+    for (i = 0; i < n_nodes; i++) {
+        sprintf(path, PLACE_NODE_DIR "/node%d/cpulist", nodes[i]);
+        n_cpus = read_list(path, cpus);
+        for (j = 0; j < n_cpus; j++) {
+            p->node[cpus[j]] = nodes[i];
+        }
+    }
+    free(nodes);
+    free(cpus);
+}
+
+/*************************************************************************
+ * Place Set Function.
+ *
+ * @param p - The placement.
+ * @param k - The index of the place.
+ * @param set - Filled with the CPUs of the place.
+ * @return void
+ *************************************************************************/
+static void place_set(const placement_t *p, int k, cpu_set_t *set) {
+    int i; /* Loop counter. */
+
+    CPU_ZERO(set);
+    for (i = p->start[k]; i < p->start[k + 1]; i++) {
+        CPU_SET(p->cpus[i], set);
+    }
+}
+
+/*************************************************************************
+ *                          Placement Functions                          *
+ *************************************************************************/
+
+/*************************************************************************
+ * Placement Init Function.
+ *
+ * This function reads a placement as given on the command line: a list
+ * of CPUs, e.g. "0-3,8", where each CPU is a place, or "node:" and a list
+ * of NUMA nodes, e.g. "node:0,1", where each node is a place.
+ *
+ * @param p - The placement to be initialized.
+ * @param spec - The placement, or NULL to leave the threads unpinned and
+ *               only sample where they run. The home node is then the
+ *               node the main thread is on.
+ * @return int - 0 on success, 1 if the placement is not valid.
+ *************************************************************************/
+int place_init(placement_t *p, const char *spec) {
+    char path[256];
+    int *ids; /* The CPUs or nodes in the spec. */
+    int n; /* The number of CPUs or nodes in the spec. */
+    int cpus[PLACE_MAX_CPUS]; /* The CPUs of a node. */
+    int count; /* The number of CPUs of a node. */
+    int cpu = sched_getcpu();
+    cpu_set_t allowed; /* The CPUs the program may run on. */
+    int i; /* Loop counter. */
+
+    memset(p, 0, sizeof(placement_t));
+    read_topology(p);
+    p->home = cpu >= 0 && cpu < PLACE_MAX_CPUS ? p->node[cpu] : 0;
+    if (spec == NULL) {
+        return 0;
+    }
+
+    p->by_node = strncmp(spec, "node:", 5) == 0;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+    }
+    ids = malloc(sizeof(int) * PLACE_MAX_CPUS);
+    p->cpus = malloc(sizeof(int) * PLACE_MAX_CPUS);
+    p->start = malloc(sizeof(int) * (PLACE_MAX_CPUS + 1));
+    if (ids == NULL || p->cpus == NULL || p->start == NULL) {
+        printf("Error: Failed to allocate the placement.\n");
+        free(ids);
+        place_destroy(p);
+        return 1;
+    }
+
+    n = parse_list(p->by_node ? spec + 5 : spec, ids, PLACE_MAX_CPUS);
+    if (n <= 0) {
+        printf("Error: The placement must be a list of CPUs, e.g. 0-3,8, or node: and a list of NUMA nodes.\n");
+        printf("Entered placement: %s\n", spec);
+        free(ids);
+        place_destroy(p);
+        return 1;
+    }
+
+    /* A CPU place holds the CPU; a node place holds every CPU of the node. */
+    p->start[0] = 0;
+    for (i = 0; i < n; i++) {
+        if (p->by_node) {
+            sprintf(path, PLACE_NODE_DIR "/node%d/cpulist", ids[i]);
+            count = read_list(path, cpus);
+            if (count <= 0 || p->start[i] + count > PLACE_MAX_CPUS) {
+                printf("Error: NUMA node %d has no CPUs.\n", ids[i]);
+                free(ids);
+                place_destroy(p);
+                return 1;
+            }
+            memcpy(p->cpus + p->start[i], cpus, sizeof(int) * count);
+            p->start[i + 1] = p->start[i] + count;
+        } else if (!CPU_ISSET(ids[i], &allowed)) {
+            printf("Error: CPU %d is not available.\n", ids[i]);
+            free(ids);
+            place_destroy(p);
+            return 1;
+        } else {
+            p->cpus[i] = ids[i];
+            p->start[i + 1] = i + 1;
+        }
+    }
+    p->n_places = n;
+    p->home = p->node[p->cpus[0]];
+    free(ids);
+    return 0;
+}
+
+/*************************************************************************
+ * Placement Destroy Function.
+ *
+ * @param p - The placement to be destroyed.
+ * @return void
+ *************************************************************************/
+void place_destroy(placement_t *p) {
+    free(p->cpus);
+    free(p->start);
+    p->cpus = NULL;
+    p->start = NULL;
+    p->n_places = 0;
+}
+
+/*************************************************************************
+ * Placement Home Function.
+ *
+ * This function moves the calling thread to the CPUs of the home node,
+ * so the memory it touches first is put on that node. Threads it creates
+ * without a place of their own, like the logger, run there too.
+ *
+ * @param p - The placement.
+ * @return int - 0 on success, 1 if the thread could not be moved.
+ *************************************************************************/
+int place_home(const placement_t *p) {
+    cpu_set_t set;
+    int cpu; /* Loop counter. */
+
+    if (p->n_places == 0) {
+        return 0;
+    }
+    CPU_ZERO(&set);
+    for (cpu = 0; cpu < PLACE_MAX_CPUS; cpu++) {
+        if (p->node[cpu] == p->home) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) != 0) {
+        printf("Error: Failed to move the main thread to NUMA node %d.\n", p->home);
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Placement Attribute Function.
+ *
+ * This function initializes the attributes for a new thread, pinned to
+ * place k. The places are used in turn, so k can be more than the number
+ * of places.
+ *
+ * @param p - The placement.
+ * @param attr - The attributes to be initialized. The caller destroys them.
+ * @param k - The index of the thread.
+ * @return int - 0 on success, 1 if the attributes could not be set.
+ *************************************************************************/
+int place_attr(const placement_t *p, pthread_attr_t *attr, int k) {
+    cpu_set_t set;
+
+    if (pthread_attr_init(attr) != 0) {
+        return 1;
+    }
+    if (p->n_places == 0) {
+        return 0;
+    }
+    place_set(p, k % p->n_places, &set);
+    if (pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &set) != 0) {
+        pthread_attr_destroy(attr);
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Placement Describe Function.
+ *
+ * @param p - The placement.
+ * @param k - The index of the thread.
+ * @param buf - Filled with the place of the thread, e.g. "cpu 3" or
+ *              "node 1". Must hold 32 characters.
+ * @return void
+ *************************************************************************/
+void place_describe(const placement_t *p, int k, char *buf) {
+    if (p->n_places == 0) {
+        strcpy(buf, "unpinned");
+    } else if (p->by_node) {
+        sprintf(buf, "node %d", p->node[p->cpus[p->start[k % p->n_places]]]);
+    } else {
+        sprintf(buf, "cpu %d", p->cpus[k % p->n_places]);
+    }
+}
+
+/*************************************************************************
+ * Placement Sample Function.
+ *
+ * This function records the CPU the calling thread is on. It is cheap
+ * enough to call for every batch, as sched_getcpu() does not enter the
+ * kernel.
+ *
+ * @param p - The placement.
+ * @param s - The statistic of the calling thread.
+ * @return void
+ *************************************************************************/
+void place_sample(const placement_t *p, place_stat_t *s) {
+    int cpu = sched_getcpu();
+
+    if (cpu < 0 || cpu >= PLACE_MAX_CPUS) {
+        return;
+    }
+    if (s->accesses > 0 && cpu != s->cpu) {
+        s->migrations++;
+    }
+    if (p->node[cpu] != p->home) {
+        s->remote++;
+    }
+    s->cpu = cpu;
+    s->accesses++;
+}
@@ -0,0 +1,74 @@
+#ifndef OS_ASSIGNMENT_20183622_PLACEMENT_H
+#define OS_ASSIGNMENT_20183622_PLACEMENT_H
+
+#include <pthread.h>
+
+#define PLACE_MAX_CPUS 1024 /* The most CPUs the placement knows about. */
+#define PLACE_NODE_DIR "/sys/devices/system/node" /* Where Linux lists the NUMA nodes and their CPUs. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for where the producer and teller threads run.
+ *
+ * Every thread is given a place, which is one CPU, or every CPU of one
+ * NUMA node, and the places are handed out in turn: the customer threads
+ * first, then the teller slots. The home node is the node of the first
+ * place. The main thread runs there while it allocates the queue and the
+ * tellers, and touches their memory first, so Linux puts the pages on
+ * that node.
+ *
+ * @param n_places - The number of places, or 0 if the threads are not pinned.
+ * @param by_node - TRUE if each place is a NUMA node, FALSE if it is one CPU.
+ * @param start - The index in cpus of the first CPU of each place, and
+ *                the end of the last place.
+ * @param cpus - The CPUs of the places.
+ * @param node - The NUMA node of each CPU.
+ * @param home - The home node.
+ *************************************************************************/
+typedef struct placement {
+    int n_places;
+    int by_node;
+    int *start;
+    int *cpus;
+    int node[PLACE_MAX_CPUS];
+    int home;
+} placement_t; /* Placement struct. */
+
+/*************************************************************************
+ * Struct for where a thread ran.
+ *
+ * The thread samples its CPU each time it takes or adds a batch of
+ * customers, which is when it touches the queue.
+ *
+ * @param cpu - The CPU of the last sample.
+ * @param migrations - The number of samples on a different CPU to the one before.
+ * @param accesses - The number of samples.
+ * @param remote - The number of samples on a CPU outside the home node.
+ *************************************************************************/
+typedef struct place_stat {
+    int cpu;
+    unsigned long migrations;
+    unsigned long accesses;
+    unsigned long remote;
+} place_stat_t; /* Placement statistic struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int place_init(placement_t *p, const char *spec);
+
+void place_destroy(placement_t *p);
+
+int place_home(const placement_t *p);
+
+int place_attr(const placement_t *p, pthread_attr_t *attr, int k);
+
+void place_describe(const placement_t *p, int k, char *buf);
+
+void place_sample(const placement_t *p, place_stat_t *s);
+
+#endif /*OS_ASSIGNMENT_20183622_PLACEMENT_H*/
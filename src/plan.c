@@ -0,0 +1,214 @@
+#include "plan.h"
+#include <math.h> /* For sqrt() */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Student t Function.
+ *
+ * @param df - The degrees of freedom.
+ * @return double - The two-sided 95% critical value of Student's t
+ *                  distribution, or the normal one above 30.
+ *************************************************************************/
+static double student_t(int df) {
+    static const double t[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+    if (df < 1) {
+        return 0.0;
+    }
+    return df <= 30 ? t[df - 1] : 1.960;
+}
+
+/*************************************************************************
+ * Evaluate Function.
+ *
+ * This function simulates a configuration once per replica, each with
+ * its own seed, on the sweep's worker threads, and checks it against the
+ * target. Every configuration is printed as it is evaluated.
+ *
+ * @param sw - The sweep holding the replicas, with its base, metric and
+ *             percentile set.
+ * @param t - The target.
+ * @param tellers - The number of tellers.
+ * @param queue_size - The size of the customer queue (m).
+ * @param v - The t_C, t_W, t_D and t_I the replicas share, as for a
+ *            sweep point.
+ * @param jobs - The number of worker threads.
+ * @param r - Filled with the result.
+ * @return int - 0 on success, 1 if a run failed.
+ *************************************************************************/
+static int evaluate(sweep_t *sw, const plan_target_t *t, int tellers, int queue_size, const int *v, int jobs,
+                    plan_result_t *r) {
+    double sum = 0, sq = 0; /* The sum and sum of squares of the percentile over the runs. */
+    double x;
+    double var; /* The sample variance of the percentile. */
+    int n = sw->n_points;
+    int i, j; /* Loop counters. */
+
+    for (i = 0; i < n; i++) {
+        memset(&sw->points[i], 0, sizeof(sweep_point_t));
+        for (j = 0; j < SWEEP_FIELDS; j++) {
+            sw->points[i].v[j] = v[j];
+        }
+        sw->points[i].v[0] = queue_size;
+        sw->points[i].v[5] = tellers;
+        sw->points[i].rep = i;
+    }
+    if (sweep_run(sw, jobs) != 0) {
+        return 1;
+    }
+
+    for (i = 0; i < n; i++) {
+        x = (double) sw->points[i].target;
+        sum += x;
+        sq += x * x;
+    }
+    r->tellers = tellers;
+    r->queue_size = queue_size;
+    r->mean = sum / n;
+    var = n > 1 ? (sq - sum * sum / n) / (n - 1) : 0.0;
+    r->half = var > 0 ? student_t(n - 1) * sqrt(var / n) : 0.0;
+    r->met = r->mean + r->half < t->limit;
+
+    printf("%7d %7d %12.3f %12.3f %12.3f  %s\n", tellers, queue_size, r->mean / 1e6, (r->mean - r->half) / 1e6,
+           (r->mean + r->half) / 1e6, r->met == TRUE ? "yes" : "no");
+    fflush(stdout);
+    return 0;
+}
+
+/*************************************************************************
+ *                             Plan Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Plan Parse Function.
+ *
+ * This function reads a target given as <wait|total>:<percentile>:<ms>,
+ * e.g. "wait:99:500" for a p99 queue wait below 500ms.
+ *
+ * @param arg - The argument.
+ * @param t - Filled with the target.
+ * @return int - 0 on success, 1 if the argument is not valid.
+ *************************************************************************/
+int plan_parse(const char *arg, plan_target_t *t) {
+    char metric[8];
+    double ms;
+    char extra;
+
+    if (sscanf(arg, "%7[a-z]:%lf:%lf%c", metric, &t->percentile, &ms, &extra) != 3 || t->percentile <= 0
+        || t->percentile > 100 || ms <= 0) {
+        return 1;
+    }
+    if (strcmp(metric, "wait") == 0) {
+        t->metric = LAT_WAIT;
+    } else if (strcmp(metric, "total") == 0) {
+        t->metric = LAT_TOTAL;
+    } else {
+        return 1;
+    }
+    t->limit = ms * 1e6;
+    return 0;
+}
+
+/*************************************************************************
+ * Plan Run Function.
+ *
+ * This function finds the cheapest configuration that meets the target:
+ * the fewest tellers, then the smallest queue. Both are found by
+ * bisection, as more tellers never make the latencies worse. The teller
+ * count is searched from 1 to the most with the largest queue, then, for
+ * an end-to-end target, the queue size from 1 to the largest with that
+ * many tellers. A smaller queue always shortens the queue wait, by
+ * keeping the customers waiting in front of it instead, so a queue wait
+ * target keeps the largest queue. Each configuration is
+ * simulated reps times with the seeds base->seed to base->seed + reps - 1,
+ * and the percentile's mean and 95% confidence interval are printed.
+ *
+ * @param base - The settings every run shares, with the service time
+ *               distributions before service_init().
+ * @param t - The target.
+ * @param v - As for a sweep point: the largest queue size to consider
+ *            (m), t_C, t_W, t_D, t_I and the most tellers to consider.
+ * @param reps - The number of seeded runs of each configuration.
+ * @param jobs - The number of worker threads, or 0 for one per CPU.
+ * @return int - 0 if a configuration meets the target, 1 if none does
+ *               or a run failed.
+ *************************************************************************/
+int plan_run(const sim_config_t *base, const plan_target_t *t, const int *v, int reps, int jobs) {
+    static const char *metrics[] = {"wait", "service", "total", "lag"};
+    sweep_t sw;
+    plan_result_t r, best;
+    int max_queue = v[0];
+    int max_tellers = v[5];
+    int lo, hi, mid;
+
+    memset(&sw, 0, sizeof(sweep_t));
+    sw.base = *base;
+    sw.metric = t->metric;
+    sw.percentile = t->percentile;
+    sw.n_points = reps;
+    sw.points = malloc(sizeof(sweep_point_t) * reps);
+    if (sw.points == NULL) {
+        printf("Error: Failed to allocate the plan.\n");
+        return 1;
+    }
+
+    printf("Target: p%g %s < %.3f ms, %d runs per configuration\n", t->percentile, metrics[t->metric], t->limit / 1e6,
+           reps);
+    printf("%7s %7s %12s %12s %12s  %s\n", "tellers", "m", "mean_ms", "ci95_lo_ms", "ci95_hi_ms", "met");
+
+    /* The most tellers with the largest queue must meet the target, or nothing will. */
+    if (evaluate(&sw, t, max_tellers, max_queue, v, jobs, &best) != 0) {
+        sweep_destroy(&sw);
+        return 1;
+    }
+    if (best.met == FALSE) {
+        printf("No configuration with up to %d tellers meets the target.\n", max_tellers);
+        sweep_destroy(&sw);
+        return 1;
+    }
+
+    /* The fewest tellers that meet the target. */
+    lo = 1;
+    hi = max_tellers;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (evaluate(&sw, t, mid, max_queue, v, jobs, &r) != 0) {
+            sweep_destroy(&sw);
+            return 1;
+        }
+        if (r.met == TRUE) {
+            hi = mid;
+            best = r;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    /* The smallest queue that those tellers meet the target with. */
+    lo = t->metric == LAT_TOTAL ? 1 : max_queue;
+    hi = max_queue;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (evaluate(&sw, t, best.tellers, mid, v, jobs, &r) != 0) {
+            sweep_destroy(&sw);
+            return 1;
+        }
+        if (r.met == TRUE) {
+            hi = mid;
+            best = r;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    printf("Cheapest: %d tellers, m=%d, p%g %s %.3f ms (95%% CI %.3f to %.3f ms)\n", best.tellers, best.queue_size,
+           t->percentile, metrics[t->metric], best.mean / 1e6, (best.mean - best.half) / 1e6,
+           (best.mean + best.half) / 1e6);
+    sweep_destroy(&sw);
+    return 0;
+}
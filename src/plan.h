@@ -0,0 +1,54 @@
+#ifndef OS_ASSIGNMENT_20183622_PLAN_H
+#define OS_ASSIGNMENT_20183622_PLAN_H
+
+#include "sweep.h"
+
+#define PLAN_REPS 5 /* The default number of seeded runs of each configuration. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a capacity planning target.
+ *
+ * A configuration meets the target when the upper end of the 95%
+ * confidence interval of the percentile, over the seeded runs, is below
+ * the limit.
+ *
+ * @param metric - LAT_WAIT (queue wait) or LAT_TOTAL (end to end).
+ * @param percentile - The percentile, from 0 to 100.
+ * @param limit - The limit, in ns.
+ *************************************************************************/
+typedef struct plan_target {
+    int metric;
+    double percentile;
+    double limit;
+} plan_target_t; /* Plan target struct. */
+
+/*************************************************************************
+ * Struct for the result of one configuration of a plan.
+ *
+ * @param tellers - The number of tellers.
+ * @param queue_size - The size of the customer queue (m).
+ * @param mean - The mean of the percentile over the runs, in ns.
+ * @param half - The half width of its 95% confidence interval, in ns.
+ * @param met - TRUE if the configuration meets the target.
+ *************************************************************************/
+typedef struct plan_result {
+    int tellers;
+    int queue_size;
+    double mean;
+    double half;
+    int met;
+} plan_result_t; /* Plan result struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int plan_parse(const char *arg, plan_target_t *t);
+
+int plan_run(const sim_config_t *base, const plan_target_t *t, const int *v, int reps, int jobs);
+
+#endif /*OS_ASSIGNMENT_20183622_PLAN_H*/
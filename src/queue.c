@@ -0,0 +1,1084 @@
+#include "queue.h"
+#include "trace.h"
+#include <limits.h> /* For INT_MAX */
+
+/*************************************************************************
+ *                           Parking Functions                           *
+ *************************************************************************/
+
+/*
+ * QUEUE_LOCKFREE and QUEUE_STEAL add and remove customers without taking
+ * c_queue.mutex. A thread that finds nothing to do waits as cq->wait
+ * says: on the condition variables, which take the mutex, or on the
+ * empty_seq and full_seq futex words, which do not. A thread counts
+ * itself in sleepers/blocked before it re-checks the queue, and the other
+ * side publishes its change before it reads the counter, so either the
+ * parking thread sees the change or the other side sees it parked. A
+ * futex waiter reads the sequence word before it counts itself, so a wake
+ * that comes between its check and its sleep changes the word and the
+ * sleep returns at once.
+ */
+
+/*************************************************************************
+ * Teller Ready Function.
+ *
+ * @param cq - The customer queue.
+ * @param teller - The index of the waiting teller.
+ * @return int - TRUE if the teller has something to do: customers to take,
+ *               the end of the file, or its retirement.
+ *************************************************************************/
+static int teller_ready(customer_queue_t *cq, int teller) {
+    return queue_count(cq) > 0 || __atomic_load_n(&cq->end_of_file, __ATOMIC_ACQUIRE) == TRUE
+           || teller >= __atomic_load_n(&cq->tellers, __ATOMIC_SEQ_CST);
+}
+
+/*************************************************************************
+ * Spin Teller Function.
+ *
+ * This function is the first part of an adaptive wait: it checks the
+ * queue cq->wait.spins times, then yields the CPU cq->wait.yields times
+ * between checks.
+ *
+ * @param cq - The customer queue.
+ * @param teller - The index of the waiting teller.
+ * @return int - TRUE if the teller has something to do, FALSE if it
+ *               should park.
+ *************************************************************************/
+static int spin_teller(customer_queue_t *cq, int teller) {
+    int i; /* Loop counter. */
+
+    for (i = 0; i < cq->wait.spins + cq->wait.yields; i++) {
+        if (teller_ready(cq, teller) == TRUE) {
+            __atomic_add_fetch(&cq->spun, 1, __ATOMIC_RELAXED);
+            return TRUE;
+        }
+        if (i < cq->wait.spins) {
+            wait_relax();
+        } else {
+            wait_yield();
+        }
+    }
+    return FALSE;
+}
+
+/*************************************************************************
+ * Park Teller Function.
+ *
+ * This function waits until the queue is not empty, the end of the file
+ * has been reached, the teller has been retired, or the deadline has
+ * passed. A futex wait can end early, so the caller checks the queue
+ * again.
+ *
+ * @param cq - The customer queue.
+ * @param teller - The index of the parking teller.
+ * @param deadline - The CLOCK_MONOTONIC time to stop waiting at, in ns, or
+ *                   -1 to wait until there is something to do.
+ * @return int - FALSE if the end of the file has been reached and the
+ *               queue is empty, or the teller has been retired, TRUE
+ *               otherwise.
+ *************************************************************************/
+static int park_teller(customer_queue_t *cq, int teller, long deadline) {
+    struct timespec ts; /* The deadline, for pthread_cond_timedwait(). */
+    int more = TRUE;
+    int seq; /* The futex word before the teller counted itself. */
+    long now;
+
+    ts.tv_sec = deadline / 1000000000L;
+    ts.tv_nsec = deadline % 1000000000L;
+
+    if (cq->wait.type == WAIT_CONDVAR) {
+        pthread_mutex_lock(&cq->mutex);
+        cq->locks++;
+        __atomic_add_fetch(&cq->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (queue_count(cq) == 0 && cq->end_of_file == FALSE && teller < cq->tellers) {
+            __atomic_add_fetch(&cq->parks, 1, __ATOMIC_RELAXED);
+            if (deadline < 0) {
+                pthread_cond_wait(&cq->empty, &cq->mutex);
+            } else if (pthread_cond_timedwait(&cq->empty, &cq->mutex, &ts) != 0) {
+                cq->locks++;
+                break; /* The deadline has passed. */
+            }
+            cq->locks++;
+        }
+        __atomic_sub_fetch(&cq->sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&cq->mutex);
+    } else if (cq->wait.type == WAIT_FUTEX || spin_teller(cq, teller) == FALSE) {
+        seq = __atomic_load_n(&cq->empty_seq, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&cq->sleepers, 1, __ATOMIC_SEQ_CST);
+        now = deadline < 0 ? 0 : now_ns();
+        if (teller_ready(cq, teller) == FALSE && (deadline < 0 || now < deadline)) {
+            __atomic_add_fetch(&cq->parks, 1, __ATOMIC_RELAXED);
+            futex_wait(&cq->empty_seq, seq, deadline < 0 ? -1 : deadline - now, cq->wait.shared);
+        }
+        __atomic_sub_fetch(&cq->sleepers, 1, __ATOMIC_SEQ_CST);
+    }
+
+    if ((__atomic_load_n(&cq->end_of_file, __ATOMIC_ACQUIRE) == TRUE && queue_count(cq) == 0)
+        || teller >= __atomic_load_n(&cq->tellers, __ATOMIC_SEQ_CST)) {
+        more = FALSE;
+    }
+
+    return more;
+}
+
+/*************************************************************************
+ * Wake Teller Function.
+ *
+ * This function wakes the tellers parked on an empty queue. It is called
+ * after customers have been added, and wakes one parked teller for each
+ * customer, so a single arrival does not wake every idle teller.
+ *
+ * @param cq - The customer queue.
+ * @param n - The number of customers added.
+ * @return void
+ *************************************************************************/
+static void wake_teller(customer_queue_t *cq, int n) {
+    int sleepers;
+    int i; /* Loop counter. */
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    sleepers = __atomic_load_n(&cq->sleepers, __ATOMIC_SEQ_CST);
+    if (sleepers <= 0) {
+        return;
+    }
+    n = n < sleepers ? n : sleepers;
+
+    if (cq->wait.type != WAIT_CONDVAR) {
+        __atomic_add_fetch(&cq->empty_seq, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&cq->empty_seq, n, cq->wait.shared);
+        return;
+    }
+
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+    for (i = 0; i < n; i++) {
+        pthread_cond_signal(&cq->empty);
+    }
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+/*************************************************************************
+ * Park Producer Function.
+ *
+ * This function waits until the queue is not full. An adaptive wait spins
+ * and yields first, as a teller does. A futex wait can end early, so the
+ * caller checks the queue again.
+ *
+ * @param cq - The customer queue.
+ * @return void
+ *************************************************************************/
+static void park_producer(customer_queue_t *cq) {
+    int seq; /* The futex word before the producer counted itself. */
+    int i; /* Loop counter. */
+
+    if (cq->wait.type == WAIT_ADAPTIVE) {
+        for (i = 0; i < cq->wait.spins + cq->wait.yields; i++) {
+            if (queue_count(cq) < cq->size) {
+                __atomic_add_fetch(&cq->spun, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            if (i < cq->wait.spins) {
+                wait_relax();
+            } else {
+                wait_yield();
+            }
+        }
+    }
+
+    if (cq->wait.type != WAIT_CONDVAR) {
+        seq = __atomic_load_n(&cq->full_seq, __ATOMIC_SEQ_CST);
+        trace_counter(TRACE_BLOCKED, __atomic_add_fetch(&cq->blocked, 1, __ATOMIC_SEQ_CST));
+        if (queue_count(cq) >= cq->size) {
+            __atomic_add_fetch(&cq->parks, 1, __ATOMIC_RELAXED);
+            futex_wait(&cq->full_seq, seq, -1, cq->wait.shared);
+        }
+        trace_counter(TRACE_BLOCKED, __atomic_sub_fetch(&cq->blocked, 1, __ATOMIC_SEQ_CST));
+        return;
+    }
+
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+    trace_counter(TRACE_BLOCKED, __atomic_add_fetch(&cq->blocked, 1, __ATOMIC_SEQ_CST));
+    while (queue_count(cq) >= cq->size) {
+        __atomic_add_fetch(&cq->parks, 1, __ATOMIC_RELAXED);
+        pthread_cond_wait(&cq->full, &cq->mutex);
+        cq->locks++;
+    }
+    trace_counter(TRACE_BLOCKED, __atomic_sub_fetch(&cq->blocked, 1, __ATOMIC_SEQ_CST));
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+/*************************************************************************
+ * Wake Producer Function.
+ *
+ * This function wakes the producers parked on a full queue. It is called
+ * after customers have been removed, and wakes one parked producer for
+ * each customer.
+ *
+ * @param cq - The customer queue.
+ * @param n - The number of customers removed.
+ * @return void
+ *************************************************************************/
+static void wake_producer(customer_queue_t *cq, int n) {
+    int blocked;
+    int i; /* Loop counter. */
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    blocked = __atomic_load_n(&cq->blocked, __ATOMIC_SEQ_CST);
+    if (blocked <= 0) {
+        return;
+    }
+    n = n < blocked ? n : blocked;
+
+    if (cq->wait.type != WAIT_CONDVAR) {
+        __atomic_add_fetch(&cq->full_seq, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&cq->full_seq, n, cq->wait.shared);
+        return;
+    }
+
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+    for (i = 0; i < n; i++) {
+        pthread_cond_signal(&cq->full);
+    }
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+/*************************************************************************
+ * Wake All Function.
+ *
+ * This function wakes every parked teller, when the end of the file has
+ * been reached or the tellers have been rescaled. The caller holds the
+ * queue mutex.
+ *
+ * @param cq - The customer queue.
+ * @return void
+ *************************************************************************/
+static void wake_all(customer_queue_t *cq) {
+    pthread_cond_broadcast(&cq->empty);
+    if (cq->wait.type != WAIT_CONDVAR) {
+        __atomic_add_fetch(&cq->empty_seq, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&cq->empty_seq, INT_MAX, cq->wait.shared);
+    }
+}
+
+/*************************************************************************
+ * Batch Size Function.
+ *
+ * This function chooses how many customers a teller claims at once. A
+ * teller takes its share of the waiting customers, so a deep queue is
+ * drained in batches while a shallow one is still handed out one customer
+ * at a time and no teller sits idle behind another teller's batch.
+ *
+ * @param cq - The customer queue.
+ * @param count - The number of customers waiting.
+ * @param max - The most customers the teller can take.
+ * @return int - The number of customers to take, at least 1.
+ *************************************************************************/
+static int batch_size(customer_queue_t *cq, int count, int max) {
+    int n = count / __atomic_load_n(&cq->tellers, __ATOMIC_RELAXED);
+
+    if (n > max) {
+        n = max;
+    }
+    return n < 1 ? 1 : n;
+}
+
+/*************************************************************************
+ * Renege Function.
+ *
+ * This function removes the customers that have run out of patience from
+ * a batch a teller has just taken, keeping the others in order. A
+ * customer reneges at its arrival time plus the patience, however late
+ * a teller reaches it. Removing the customers as they reach the front,
+ * instead of searching the queue for them, costs one comparison each.
+ * Only the mutex queue in FIFO order, where expire() frees the slots of
+ * the waiting customers too, is used with a patience (see main()).
+ *
+ * @param cq - The customer queue.
+ * @param c - The customers taken.
+ * @param n - The number of customers taken.
+ * @return int - The number of customers left in c.
+ *************************************************************************/
+static int renege(customer_queue_t *cq, customer_t *c, int n) {
+    long now = now_ns();
+    int kept = 0; /* The number of customers kept. */
+    int i; /* Loop counter. */
+
+    for (i = 0; i < n; i++) {
+        if (now - c[i].arrival_time <= cq->patience) {
+            c[kept++] = c[i];
+        } else {
+            log_departure(&c[i], "Reneged", c[i].arrival_time + cq->patience);
+        }
+    }
+    if (kept < n) {
+        __atomic_add_fetch(&cq->reneged, n - kept, __ATOMIC_RELAXED);
+    }
+    return kept;
+}
+
+/*************************************************************************
+ * Expire Function.
+ *
+ * This function removes the customers that have run out of patience
+ * from the front of the mutex queue, so a producer waiting on a full
+ * queue gets their slots when they renege, not when a teller reaches
+ * them. The customers of a FIFO queue run out of patience in the order
+ * they arrived, so they are always at the front. The caller holds the
+ * queue mutex.
+ *
+ * @param cq - The customer queue, with no scheduling policy.
+ * @param now - The current time, in ns.
+ * @return int - The number of customers removed.
+ *************************************************************************/
+static int expire(customer_queue_t *cq, long now) {
+    int n = 0; /* The number of customers removed. */
+
+    while (cq->count > 0 && now - cq->q[cq->out].arrival_time > cq->patience) {
+        log_departure(&cq->q[cq->out], "Reneged", cq->q[cq->out].arrival_time + cq->patience);
+        cq->out = (cq->out + 1) % cq->size;
+        cq->count--;
+        n++;
+    }
+    if (n > 0) {
+        __atomic_add_fetch(&cq->reneged, n, __ATOMIC_RELAXED);
+    }
+    return n;
+}
+
+/*************************************************************************
+ *                            Deque Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Deque Push Function.
+ *
+ * This function adds customers to the back of a teller's deque. The
+ * producer has already reserved room in the queue, so the deque always
+ * has enough free slots.
+ *
+ * @param cq - The customer queue.
+ * @param d - The deque.
+ * @param c - The customers to be added.
+ * @param n - The number of customers to be added.
+ * @return void
+ *************************************************************************/
+static void deque_push(customer_queue_t *cq, deque_t *d, const customer_t *c, int n) {
+    int i; /* Loop counter. */
+
+    pthread_mutex_lock(&d->mutex);
+    d->locks++;
+    for (i = 0; i < n; i++) {
+        d->q[(d->front + d->count) % cq->size] = c[i];
+        d->count++;
+    }
+    pthread_mutex_unlock(&d->mutex);
+}
+
+/*************************************************************************
+ * Deque Pop Function.
+ *
+ * This function takes customers from a deque. The owning teller takes
+ * them from the front, and a stealing teller takes at most half of them
+ * from the back.
+ *
+ * @param cq - The customer queue.
+ * @param d - The deque.
+ * @param c - The customers to be filled.
+ * @param max - The most customers to take.
+ * @param steal - TRUE to take from the back of the deque.
+ * @return int - The number of customers taken, 0 if the deque is empty.
+ *************************************************************************/
+static int deque_pop(customer_queue_t *cq, deque_t *d, customer_t *c, int max, int steal) {
+    int n; /* The number of customers taken. */
+    int i; /* Loop counter. */
+
+    /* Check without the lock first, so idle tellers do not hammer empty deques. */
+    if (__atomic_load_n(&d->count, __ATOMIC_RELAXED) == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&d->mutex);
+    d->locks++;
+    n = steal == TRUE ? (d->count + 1) / 2 : d->count;
+    if (n > max) {
+        n = max;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (steal == TRUE) {
+            c[i] = d->q[(d->front + d->count - 1) % cq->size];
+        } else {
+            c[i] = d->q[d->front];
+            d->front = (d->front + 1) % cq->size;
+        }
+        d->count--;
+    }
+    pthread_mutex_unlock(&d->mutex);
+
+    return n;
+}
+
+/*************************************************************************
+ *                            Queue Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Queue Init Function.
+ *
+ * This function initializes a customer queue of the given type. The
+ * customer slots are written here, so their pages are put on the NUMA
+ * node of the calling thread rather than of the first thread to use them.
+ *
+ * @param cq - The customer queue to be initialized.
+ * @param type - The queue implementation (QUEUE_MUTEX, QUEUE_LOCKFREE or QUEUE_STEAL).
+ * @param size - The size/length of the customer queue (m).
+ * @param tellers - The number of tellers, which is the number of deques for QUEUE_STEAL.
+ *                  With autoscaling this is the most tellers, and queue_scale()
+ *                  sets how many of them take customers.
+ * @param producers - The number of producers, each of which calls queue_close() once.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int queue_init(customer_queue_t *cq, int type, int size, int tellers, int producers) {
+    return queue_init_shared(cq, type, size, tellers, producers, NULL);
+}
+
+/*************************************************************************
+ * Queue Init Shared Function.
+ *
+ * This function initializes a customer queue that producers and tellers
+ * in different processes can use. The queue struct must itself be in the
+ * shared memory segment, its slots are allocated from the segment, and
+ * the mutex and condition variables are process-shared. Only the
+ * QUEUE_LOCKFREE ring can be shared, as the other queues keep pointers to
+ * memory of their own.
+ *
+ * @param cq - The customer queue to be initialized.
+ * @param type - The queue implementation.
+ * @param size - The size/length of the customer queue (m).
+ * @param tellers - The number of tellers.
+ * @param producers - The number of producers, each of which calls queue_close() once.
+ * @param shm - The segment to allocate the slots from, or NULL for a
+ *              queue private to this process.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int queue_init_shared(customer_queue_t *cq, int type, int size, int tellers, int producers, shm_t *shm) {
+    pthread_mutexattr_t mattr; /* The attributes of the mutex. */
+    pthread_condattr_t attr; /* The attributes of the condition variables. */
+    void *mem; /* The slots of a shared ring. */
+    int pshared = shm != NULL ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
+    int i; /* Loop counter. */
+
+    if (shm != NULL && type != QUEUE_LOCKFREE) {
+        printf("Error: Only the lockfree queue can be shared between processes.\n");
+        return 1;
+    }
+
+    memset(cq, 0, sizeof(customer_queue_t));
+    cq->type = type;
+    cq->size = size;
+    cq->tellers = tellers;
+    cq->producers = producers;
+    cq->end_of_file = FALSE;
+    cq->shared = shm != NULL;
+
+    /* Initialize the customer queue mutex. */
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, pshared);
+    if (pthread_mutex_init(&cq->mutex, &mattr) != 0) {
+        printf("Error: Failed to initialize the customer queue mutex.\n");
+        pthread_mutexattr_destroy(&mattr);
+        return 1;
+    }
+    pthread_mutexattr_destroy(&mattr);
+
+    /* Initialize the customer queue condition variables. A timed wait counts on the monotonic clock, like now_ns(). */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setpshared(&attr, pshared);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_cond_init(&cq->full, &attr) != 0) {
+        printf("Error: Failed to initialize the customer queue full condition variable.\n");
+        pthread_condattr_destroy(&attr);
+        return 1;
+    }
+    if (pthread_cond_init(&cq->empty, &attr) != 0) {
+        printf("Error: Failed to initialize the customer queue empty condition variable.\n");
+        pthread_condattr_destroy(&attr);
+        return 1;
+    }
+    pthread_condattr_destroy(&attr);
+
+    if (shm != NULL) {
+        mem = shm_alloc(shm, ring_bytes(size, sizeof(customer_t)));
+        if (mem == NULL) {
+            printf("Error: Failed to allocate the customer queue.\n");
+            return 1;
+        }
+        ring_init_at(&cq->ring, size, sizeof(customer_t), mem);
+    } else if (type == QUEUE_LOCKFREE) {
+        if (ring_init(&cq->ring, size, sizeof(customer_t)) != 0) {
+            printf("Error: Failed to allocate the customer queue.\n");
+            return 1;
+        }
+    } else if (type == QUEUE_STEAL) {
+        /* Every deque can hold the whole queue, as the producer bounds the total to m. */
+        cq->n_deques = tellers;
+        cq->deques = calloc(tellers, sizeof(deque_t));
+        if (cq->deques == NULL) {
+            printf("Error: Failed to allocate the customer queue.\n");
+            return 1;
+        }
+        for (i = 0; i < tellers; i++) {
+            cq->deques[i].q = malloc(sizeof(struct customer) * size);
+            if (cq->deques[i].q == NULL || pthread_mutex_init(&cq->deques[i].mutex, NULL) != 0) {
+                printf("Error: Failed to allocate the customer queue.\n");
+                return 1;
+            }
+            memset(cq->deques[i].q, 0, sizeof(struct customer) * size);
+        }
+    } else {
+        cq->q = malloc(sizeof(struct customer) * size);
+        if (cq->q == NULL) {
+            printf("Error: Failed to allocate the customer queue.\n");
+            return 1;
+        }
+        memset(cq->q, 0, sizeof(struct customer) * size);
+    }
+
+    return 0;
+}
+
+/*************************************************************************
+ * Queue Destroy Function.
+ *
+ * @param cq - The customer queue to be destroyed.
+ * @return void
+ *************************************************************************/
+void queue_destroy(customer_queue_t *cq) {
+    int i; /* Loop counter. */
+
+    free(cq->q); /* Free the queue. */
+    if (cq->shared == FALSE) {
+        ring_destroy(&cq->ring); /* A shared ring is freed with its segment. */
+    }
+    for (i = 0; i < cq->n_deques; i++) {
+        free(cq->deques[i].q);
+        pthread_mutex_destroy(&cq->deques[i].mutex);
+    }
+    free(cq->deques);
+    if (cq->sched != NULL) {
+        sched_destroy(cq->sched);
+        free(cq->sched);
+    }
+
+    /* Destroy the mutex and the condition variables. */
+    pthread_mutex_destroy(&cq->mutex);
+    pthread_cond_destroy(&cq->full);
+    pthread_cond_destroy(&cq->empty);
+}
+
+/*************************************************************************
+ * Queue Count Function.
+ *
+ * @param cq - The customer queue.
+ * @return int - The number of customers in the queue.
+ *************************************************************************/
+int queue_count(customer_queue_t *cq) {
+    if (cq->type == QUEUE_LOCKFREE) {
+        return (int) ring_count(&cq->ring);
+    } else if (cq->type == QUEUE_STEAL) {
+        return __atomic_load_n(&cq->count, __ATOMIC_SEQ_CST);
+    }
+    return __atomic_load_n(&cq->count, __ATOMIC_RELAXED);
+}
+
+/*************************************************************************
+ * Queue Put Batch Function.
+ *
+ * This function waits for the queue to not be full, then adds as many of
+ * the customers as there is room for, setting their arrival times and
+ * logging their arrivals. A batch takes the queue mutex and wakes the
+ * tellers once. The arrivals are always logged before a teller can take
+ * the customers.
+ *
+ * @param cq - The customer queue.
+ * @param c - The customers to be added.
+ * @param n - The number of customers to be added, at least 1.
+ * @return int - The number of customers added, from 1 to n.
+ *************************************************************************/
+int queue_put_batch(customer_queue_t *cq, customer_t *c, int n) {
+    struct timespec ts; /* When the customer at the front reneges, for pthread_cond_timedwait(). */
+    long arrival_time;
+    int count;
+    int tellers; /* The number of tellers taking customers. */
+    int added; /* The number of customers added. */
+    int i; /* Loop counter. */
+
+    if (cq->type == QUEUE_LOCKFREE) {
+        for (added = 0; added < n; added++) {
+            /* Wait for the queue to not be full, but only for the first customer. */
+            if (queue_count(cq) >= cq->size) {
+                if (added > 0) {
+                    break;
+                }
+                park_producer(cq);
+            }
+
+            /* The slot holds the stamp, but the arrival is only logged once the customer is in the queue. */
+            c[added].arrival_time = now_ns();
+
+            /* Another producer may have taken the free slot; if so, wait again. */
+            if (ring_push(&cq->ring, &c[added]) == FALSE) {
+                if (added > 0) {
+                    break;
+                }
+                added--;
+                continue;
+            }
+            log_arrival(&c[added]);
+        }
+        __atomic_add_fetch(&cq->arrivals, added, __ATOMIC_RELAXED);
+        wake_teller(cq, added);
+        return added;
+    }
+
+    if (cq->type == QUEUE_STEAL) {
+        /* Reserve room for the customers, waiting while the queue is full. */
+        for (;;) {
+            count = __atomic_load_n(&cq->count, __ATOMIC_SEQ_CST);
+            added = cq->size - count < n ? cq->size - count : n;
+            if (added <= 0) {
+                park_producer(cq);
+            } else if (__atomic_compare_exchange_n(&cq->count, &count, count + added, FALSE,
+                                                   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+                break;
+            }
+        }
+
+        arrival_time = now_ns();
+        for (i = 0; i < added; i++) {
+            c[i].arrival_time = arrival_time;
+            log_arrival(&c[i]);
+        }
+
+        /* Hand the customers to the working tellers in turn, in one run per deque. */
+        tellers = __atomic_load_n(&cq->tellers, __ATOMIC_RELAXED);
+        count = (added + tellers - 1) / tellers;
+        for (i = 0; i < added; i += count) {
+            deque_push(cq, &cq->deques[__atomic_fetch_add(&cq->next, 1, __ATOMIC_RELAXED) % tellers], &c[i],
+                       added - i < count ? added - i : count);
+        }
+        __atomic_add_fetch(&cq->arrivals, added, __ATOMIC_RELAXED);
+        wake_teller(cq, added);
+        return added;
+    }
+
+    /* Lock the queue. */
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+
+    /*************************************************************************
+     *                           Critical Section                            *
+     *************************************************************************/
+
+    /* Wait for the queue to not be full, or for the customer at the front to renege. */
+    while (cq->count == cq->size) {
+        if (cq->patience > 0 && cq->sched == NULL) {
+            arrival_time = now_ns();
+            if (expire(cq, arrival_time) > 0) {
+                break;
+            }
+            arrival_time = cq->q[cq->out].arrival_time + cq->patience + 1;
+            ts.tv_sec = arrival_time / 1000000000L;
+            ts.tv_nsec = arrival_time % 1000000000L;
+        }
+        cq->blocked++;
+        cq->parks++;
+        trace_counter(TRACE_BLOCKED, cq->blocked);
+        if (cq->patience > 0 && cq->sched == NULL) {
+            pthread_cond_timedwait(&cq->full, &cq->mutex, &ts);
+        } else {
+            pthread_cond_wait(&cq->full, &cq->mutex);
+        }
+        cq->blocked--;
+        trace_counter(TRACE_BLOCKED, cq->blocked);
+        cq->locks++;
+    }
+
+    /* Add as many customers as there is room for. */
+    added = cq->size - cq->count < n ? cq->size - cq->count : n;
+
+    /* Get the current time. */
+    arrival_time = now_ns();
+    for (i = 0; i < added; i++) {
+        c[i].arrival_time = arrival_time;
+        if (cq->sched != NULL) {
+            sched_put(cq->sched, &c[i]);
+        } else {
+            cq->q[cq->in] = c[i];
+        }
+
+        /* Print the customer information. */
+        log_arrival(&c[i]);
+
+        /* Increment the queue in. */
+        cq->in = (cq->in + 1) % cq->size;
+    }
+
+    /* Increment the queue size. */
+    cq->count += added;
+    __atomic_add_fetch(&cq->arrivals, added, __ATOMIC_RELAXED);
+
+    /*************************************************************************
+     *                        End of Critical Section                        *
+     *************************************************************************/
+
+    /* Signal that the queue is not empty, once for each customer up to the number of waiting tellers. */
+    for (i = 0; i < added && i < cq->sleepers; i++) {
+        pthread_cond_signal(&cq->empty);
+    }
+
+    /* Unlock the queue. */
+    pthread_mutex_unlock(&cq->mutex);
+
+    return added;
+}
+
+/*************************************************************************
+ * Take Function.
+ *
+ * This function waits for customers and removes a batch of them from the
+ * queue. The batch grows with the queue depth (see batch_size()), so one
+ * lock acquisition serves several customers when the tellers fall behind.
+ * With QUEUE_STEAL the teller takes from its own deque first, then steals
+ * from the other tellers' deques, starting with its neighbour. A teller
+ * that has other work to get back to, like an event-loop worker with
+service completions due, waits no later than the deadline.
+ *
+ * @param cq - The customer queue.
+ * @param c - The customers to be filled.
+ * @param max - The most customers to take.
+ * @param teller - The index of the teller asking for customers.
+ * @param deadline - The CLOCK_MONOTONIC time to stop waiting at, in ns, or
+ *                   -1 to wait until there are customers.
+ * @return int - The number of customers removed, 0 if the end of the file
+ *               has been reached and the queue is empty, or the teller has
+ *               been retired by queue_scale(), or QUEUE_TIMEOUT if the
+ *               deadline passed with the queue empty.
+ *************************************************************************/
+static int take(customer_queue_t *cq, customer_t *c, int max, int teller, long deadline) {
+    struct timespec ts; /* The deadline, for pthread_cond_timedwait(). */
+    int want; /* The number of customers to take. */
+    int taken; /* The number of customers taken. */
+    int i; /* Loop counter. */
+
+    if (cq->type == QUEUE_LOCKFREE) {
+        do {
+            if (teller >= __atomic_load_n(&cq->tellers, __ATOMIC_RELAXED)) {
+                return 0; /* The teller has been retired. */
+            }
+            want = batch_size(cq, queue_count(cq), max);
+            taken = 0;
+            while (taken < want && ring_pop(&cq->ring, &c[taken]) == TRUE) {
+                taken++;
+            }
+            if (taken > 0) {
+                wake_producer(cq, taken);
+                return taken;
+            }
+            if (deadline >= 0 && now_ns() >= deadline) {
+                return QUEUE_TIMEOUT;
+            }
+        } while (park_teller(cq, teller, deadline) == TRUE);
+        return 0;
+    }
+
+    if (cq->type == QUEUE_STEAL) {
+        do {
+            if (teller >= __atomic_load_n(&cq->tellers, __ATOMIC_RELAXED)) {
+                return 0; /* The teller has been retired. */
+            }
+            want = batch_size(cq, queue_count(cq), max);
+            for (i = 0; i < cq->n_deques; i++) {
+                taken = deque_pop(cq, &cq->deques[(teller + i) % cq->n_deques], c, want, i > 0);
+                if (taken > 0) {
+                    __atomic_sub_fetch(&cq->count, taken, __ATOMIC_SEQ_CST);
+                    wake_producer(cq, taken);
+                    return taken;
+                }
+            }
+            if (deadline >= 0 && now_ns() >= deadline) {
+                return QUEUE_TIMEOUT;
+            }
+        } while (park_teller(cq, teller, deadline) == TRUE);
+        return 0;
+    }
+
+    /* An adaptive wait spins on the count before it takes the lock. The mutex queue always parks on its condition variable. */
+    if (cq->wait.type == WAIT_ADAPTIVE && __atomic_load_n(&cq->count, __ATOMIC_RELAXED) == 0) {
+        spin_teller(cq, teller);
+    }
+
+    /* Lock the queue. */
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+
+    /*************************************************************************
+     *                           Critical Section                            *
+     *************************************************************************/
+
+    /* Wait for the queue to not be empty, or for the deadline. */
+    ts.tv_sec = deadline / 1000000000L;
+    ts.tv_nsec = deadline % 1000000000L;
+    while (cq->count == 0 && cq->end_of_file == FALSE && teller < cq->tellers) {
+        cq->sleepers++;
+        cq->parks++;
+        if (deadline < 0) {
+            pthread_cond_wait(&cq->empty, &cq->mutex);
+        } else if (pthread_cond_timedwait(&cq->empty, &cq->mutex, &ts) != 0 && cq->count == 0
+                   && cq->end_of_file == FALSE && teller < cq->tellers) {
+            cq->sleepers--;
+            cq->locks++;
+            pthread_mutex_unlock(&cq->mutex);
+            return QUEUE_TIMEOUT;
+        }
+        cq->sleepers--;
+        cq->locks++;
+    }
+
+    /* Check if the end of the file has been reached, or the teller has been retired. */
+    if ((cq->end_of_file == TRUE && cq->count == 0) || teller >= cq->tellers) {
+        /* Unlock the queue. */
+        pthread_mutex_unlock(&cq->mutex);
+        return 0;
+    }
+
+    taken = batch_size(cq, cq->count, max);
+    for (i = 0; i < taken; i++) {
+        /* Set the current customer, letting the scheduling policy choose if there is one. */
+        if (cq->sched != NULL) {
+            sched_get(cq->sched, &c[i]);
+        } else {
+            c[i] = cq->q[cq->out];
+        }
+
+        /* Increment the queue out. */
+        cq->out = (cq->out + 1) % cq->size;
+    }
+
+    /* Decrement the queue size. */
+    cq->count -= taken;
+
+    /*************************************************************************
+     *                        End of Critical Section                        *
+     *************************************************************************/
+
+    /* Signal that the queue is no longer full, once for each customer up to the number of waiting producers. */
+    for (i = 0; i < taken && i < cq->blocked; i++) {
+        pthread_cond_signal(&cq->full);
+    }
+
+    /* Unlock the queue. */
+    pthread_mutex_unlock(&cq->mutex);
+
+    return taken;
+}
+
+/*************************************************************************
+ * Queue Get Until Function.
+ *
+ * This function waits for customers and removes a batch of them from the
+ * queue (see take()). With a patience set, the customers that reneged
+ * while they waited are dropped from the batch, and the teller waits
+ * again if none are left.
+ *
+ * @param cq - The customer queue.
+ * @param c - The customers to be filled.
+ * @param max - The most customers to take.
+ * @param teller - The index of the teller asking for customers.
+ * @param deadline - The CLOCK_MONOTONIC time to stop waiting at, in ns, or
+ *                   -1 to wait until there are customers.
+ * @return int - As for take().
+ *************************************************************************/
+int queue_get_until(customer_queue_t *cq, customer_t *c, int max, int teller, long deadline) {
+    int taken; /* The number of customers taken. */
+
+    for (;;) {
+        taken = take(cq, c, max, teller, deadline);
+        if (taken <= 0 || cq->patience <= 0) {
+            return taken;
+        }
+        taken = renege(cq, c, taken);
+        if (taken > 0) {
+            return taken;
+        }
+    }
+}
+
+/*************************************************************************
+ * Queue Get Batch Function.
+ *
+ * This function waits for customers, with no deadline (see
+ * queue_get_until()).
+ *
+ * @param cq - The customer queue.
+ * @param c - The customers to be filled.
+ * @param max - The most customers to take.
+ * @param teller - The index of the teller asking for customers.
+ * @return int - The number of customers removed, or 0 if the end of the
+ *               file has been reached and the queue is empty, or the
+ *               teller has been retired by queue_scale().
+ *************************************************************************/
+int queue_get_batch(customer_queue_t *cq, customer_t *c, int max, int teller) {
+    return queue_get_until(cq, c, max, teller, -1);
+}
+
+/*************************************************************************
+ * Queue Close Function.
+ *
+ * This function is called by each producer once it has added its last
+ * customer. When the last producer closes the queue it marks the end of
+ * the file and wakes up the tellers, so that they shut down once the
+ * queue is empty.
+ *
+ * @param cq - The customer queue.
+ * @return void
+ *************************************************************************/
+void queue_close(customer_queue_t *cq) {
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+    cq->producers--;
+    if (cq->producers == 0) {
+        __atomic_store_n(&cq->end_of_file, TRUE, __ATOMIC_RELEASE);
+        /* Wake up every teller, and they will shut down once the queue is empty. */
+        wake_all(cq);
+    }
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+/*************************************************************************
+ * Queue Scale Function.
+ *
+ * This function sets how many tellers take customers. Tellers with an
+ * index of n or more are retired: queue_get_batch() returns 0 to them
+ * once they ask for their next batch, and the parked ones are woken up so
+ * that they can leave. Tellers below n that are not running yet must be
+ * started after this call.
+ *
+ * @param cq - The customer queue.
+ * @param n - The number of tellers, up to the number given to queue_init().
+ * @return void
+ *************************************************************************/
+void queue_scale(customer_queue_t *cq, int n) {
+    pthread_mutex_lock(&cq->mutex);
+    cq->locks++;
+    __atomic_store_n(&cq->tellers, n, __ATOMIC_SEQ_CST);
+    wake_all(cq);
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+/*************************************************************************
+ * Queue Wait Function.
+ *
+ * This function sets how the tellers wait on an empty queue and the
+ * producers on a full one. QUEUE_LOCKFREE and QUEUE_STEAL park on a
+ * futex with WAIT_FUTEX and WAIT_ADAPTIVE. QUEUE_MUTEX waits inside its
+ * critical section, so it always parks on its condition variables, and
+ * WAIT_ADAPTIVE only adds the spin before the teller takes the mutex. It
+ * must be called before the threads are started. A queue shared between
+ * processes parks on process-shared futexes.
+ *
+ * @param cq - The customer queue.
+ * @param w - The wait strategy.
+ * @return void
+ *************************************************************************/
+void queue_wait(customer_queue_t *cq, const wait_t *w) {
+    cq->wait = *w;
+    cq->wait.shared = cq->shared;
+}
+
+/*************************************************************************
+ * Queue Patience Function.
+ *
+ * This function makes the customers renege once they have waited longer
+ * than patience. It must be called before any customer is added.
+ *
+ * @param cq - The customer queue.
+ * @param patience - How long a customer waits, in ns, or 0 to wait
+ *                   until served.
+ * @return void
+ *************************************************************************/
+void queue_patience(customer_queue_t *cq, long patience) {
+    cq->patience = patience;
+}
+
+/*************************************************************************
+ * Queue Schedule Function.
+ *
+ * This function replaces the single FIFO array of a QUEUE_MUTEX queue
+ * with a queue per service type and a scheduling policy that chooses the
+ * next customer. It must be called before the threads are started.
+ *
+ * @param cq - The customer queue.
+ * @param policy - The scheduling policy.
+ * @param cost - The expected service time of 'W', 'D' and 'I'.
+ * @param weight - The weight of 'W', 'D' and 'I'.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int queue_schedule(customer_queue_t *cq, int policy, const double *cost, const double *weight) {
+    if (cq->type != QUEUE_MUTEX) {
+        printf("Error: Scheduling policies need the mutex queue.\n");
+        return 1;
+    }
+
+    cq->sched = malloc(sizeof(sched_t));
+    if (cq->sched == NULL || sched_init(cq->sched, policy, cq->size, cost, weight) != 0) {
+        printf("Error: Failed to allocate the customer queue.\n");
+        free(cq->sched);
+        cq->sched = NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*************************************************************************
+ * Queue Locks Function.
+ *
+ * This function counts how many times the queue's locks were taken,
+ * including the per-teller deque locks. It must be called once the
+ * threads have stopped.
+ *
+ * @param cq - The customer queue.
+ * @return unsigned long - The number of lock acquisitions.
+ *************************************************************************/
+unsigned long queue_locks(const customer_queue_t *cq) {
+    unsigned long locks = cq->locks;
+    int i; /* Loop counter. */
+
+    for (i = 0; i < cq->n_deques; i++) {
+        locks += cq->deques[i].locks;
+    }
+    return locks;
+}
+
+/*************************************************************************
+ * Queue Type Function.
+ *
+ * This function converts the name of a queue implementation, as given on
+ * the command line, to its type.
+ *
+ * @param name - The name of the queue implementation ("mutex", "lockfree" or "steal").
+ * @return int - The queue type, or -1 if the name is not known.
+ *************************************************************************/
+int queue_type(const char *name) {
+    if (strcmp(name, "mutex") == 0) {
+        return QUEUE_MUTEX;
+    } else if (strcmp(name, "lockfree") == 0) {
+        return QUEUE_LOCKFREE;
+    } else if (strcmp(name, "steal") == 0) {
+        return QUEUE_STEAL;
+    }
+    return -1;
+}
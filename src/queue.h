@@ -0,0 +1,47 @@
+#ifndef OS_ASSIGNMENT_20183622_QUEUE_H
+#define OS_ASSIGNMENT_20183622_QUEUE_H
+
+#include "standard.h"
+#include "scheduler.h"
+#include "shm.h"
+
+#define QUEUE_MUTEX 0 /* A circular array guarded by one mutex and two condition variables. */
+#define QUEUE_LOCKFREE 1 /* A lock-free ring, with the condition variables only used to park. */
+#define QUEUE_STEAL 2 /* A deque per teller, with idle tellers stealing from busy ones. */
+
+#define QUEUE_BATCH 32 /* The most customers added or taken with one lock acquisition. */
+#define QUEUE_TIMEOUT (-1) /* Returned by queue_get_until() when the deadline passes first. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int queue_init(customer_queue_t *cq, int type, int size, int tellers, int producers);
+
+int queue_init_shared(customer_queue_t *cq, int type, int size, int tellers, int producers, shm_t *shm);
+
+void queue_destroy(customer_queue_t *cq);
+
+int queue_put_batch(customer_queue_t *cq, customer_t *c, int n);
+
+int queue_get_until(customer_queue_t *cq, customer_t *c, int max, int teller, long deadline);
+
+int queue_get_batch(customer_queue_t *cq, customer_t *c, int max, int teller);
+
+void queue_close(customer_queue_t *cq);
+
+void queue_scale(customer_queue_t *cq, int n);
+
+int queue_count(customer_queue_t *cq);
+
+unsigned long queue_locks(const customer_queue_t *cq);
+
+void queue_wait(customer_queue_t *cq, const wait_t *w);
+
+void queue_patience(customer_queue_t *cq, long patience);
+
+int queue_schedule(customer_queue_t *cq, int policy, const double *cost, const double *weight);
+
+int queue_type(const char *name);
+
+#endif /*OS_ASSIGNMENT_20183622_QUEUE_H*/
@@ -0,0 +1,191 @@
+#include "standard.h"
+
+/*************************************************************************
+ *                            Ring Functions                             *
+ *************************************************************************/
+
+/*************************************************************************
+ * Ring Init Function.
+ *
+ * This function allocates the slots of a ring and sets each slot's
+ * sequence number to its index, which marks every slot as writable.
+ *
+ * @param r - The ring to be initialized.
+ * @param capacity - The number of slots in the ring.
+ * @param elem_size - The size of one element, in bytes.
+ * @return int - 0 on success, 1 if the slots could not be allocated.
+ *************************************************************************/
+int ring_init(ring_t *r, unsigned long capacity, size_t elem_size) {
+    unsigned long i; /* Loop counter. */
+
+    memset(r, 0, sizeof(ring_t));
+    r->capacity = capacity;
+    r->elem_size = elem_size;
+    r->seq = malloc(sizeof(unsigned long) * capacity);
+    r->data = malloc(elem_size * capacity);
+
+    if (r->seq == NULL || r->data == NULL) {
+        ring_destroy(r);
+        return 1;
+    }
+
+    for (i = 0; i < capacity; i++) {
+        r->seq[i] = i;
+    }
+    memset(r->data, 0, elem_size * capacity);
+
+    return 0;
+}
+
+/*************************************************************************
+ * Ring Bytes Function.
+ *
+ * @param capacity - The number of slots in the ring.
+ * @param elem_size - The size of one element, in bytes.
+ * @return size_t - The memory ring_init_at() needs for the slots.
+ *************************************************************************/
+size_t ring_bytes(unsigned long capacity, size_t elem_size) {
+    return (sizeof(unsigned long) + elem_size) * capacity;
+}
+
+/*************************************************************************
+ * Ring Init At Function.
+ *
+ * This function initializes a ring whose slots are in memory the caller
+ * owns, such as a shared memory segment. The ring must not be passed to
+ * ring_destroy().
+ *
+ * @param r - The ring to be initialized.
+ * @param capacity - The number of slots in the ring.
+ * @param elem_size - The size of one element, in bytes.
+ * @param mem - At least ring_bytes(capacity, elem_size) bytes, aligned
+ *              for an unsigned long.
+ * @return void
+ *************************************************************************/
+void ring_init_at(ring_t *r, unsigned long capacity, size_t elem_size, void *mem) {
+    unsigned long i; /* Loop counter. */
+
+    memset(r, 0, sizeof(ring_t));
+    r->capacity = capacity;
+    r->elem_size = elem_size;
+    r->seq = mem;
+    r->data = (char *) mem + sizeof(unsigned long) * capacity;
+
+    for (i = 0; i < capacity; i++) {
+        r->seq[i] = i;
+    }
+    memset(r->data, 0, elem_size * capacity);
+}
+
+/*************************************************************************
+ * Ring Destroy Function.
+ *
+ * @param r - The ring to be destroyed.
+ * @return void
+ *************************************************************************/
+void ring_destroy(ring_t *r) {
+    free(r->seq);
+    free(r->data);
+    r->seq = NULL;
+    r->data = NULL;
+}
+
+/*************************************************************************
+ * Ring Push Function.
+ *
+ * This function copies an element into the ring without blocking.
+ *
+ * @param r - The ring.
+ * @param elem - The element to be copied in.
+ * @return int - TRUE if the element was added, FALSE if the ring is full.
+ *************************************************************************/
+int ring_push(ring_t *r, const void *elem) {
+    unsigned long pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    unsigned long slot;
+    unsigned long seq;
+    long diff;
+
+    for (;;) {
+        slot = pos % r->capacity;
+        seq = __atomic_load_n(&r->seq[slot], __ATOMIC_ACQUIRE);
+        diff = (long) (seq - pos);
+
+        if (diff == 0) {
+            /* The slot is free, so try to claim the position. */
+            if (__atomic_compare_exchange_n(&r->head, &pos, pos + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return FALSE; /* The slot has not been read yet, so the ring is full. */
+        } else {
+            pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(r->data + slot * r->elem_size, elem, r->elem_size);
+
+    /* Publish the element to the consumers. */
+    __atomic_store_n(&r->seq[slot], pos + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+/*************************************************************************
+ * Ring Pop Function.
+ *
+ * This function copies the oldest element out of the ring without
+ * blocking.
+ *
+ * @param r - The ring.
+ * @param elem - The element to be filled.
+ * @return int - TRUE if an element was removed, FALSE if the ring is empty.
+ *************************************************************************/
+int ring_pop(ring_t *r, void *elem) {
+    unsigned long pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    unsigned long slot;
+    unsigned long seq;
+    long diff;
+
+    for (;;) {
+        slot = pos % r->capacity;
+        seq = __atomic_load_n(&r->seq[slot], __ATOMIC_ACQUIRE);
+        diff = (long) (seq - (pos + 1));
+
+        if (diff == 0) {
+            /* The slot has been published, so try to claim the position. */
+            if (__atomic_compare_exchange_n(&r->tail, &pos, pos + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return FALSE; /* The slot has not been written yet, so the ring is empty. */
+        } else {
+            pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(elem, r->data + slot * r->elem_size, r->elem_size);
+
+    /* Hand the slot back to the producers for the next lap. */
+    __atomic_store_n(&r->seq[slot], pos + r->capacity, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+/*************************************************************************
+ * Ring Count Function.
+ *
+ * This function returns the number of elements in the ring. The value is
+ * only a snapshot while other threads are pushing or popping.
+ *
+ * @param r - The ring.
+ * @return unsigned long - The number of elements in the ring.
+ *************************************************************************/
+unsigned long ring_count(ring_t *r) {
+    unsigned long tail = __atomic_load_n(&r->tail, __ATOMIC_SEQ_CST);
+    unsigned long head = __atomic_load_n(&r->head, __ATOMIC_SEQ_CST);
+
+    if (head < tail) {
+        return 0; /* A pop finished between the two loads. */
+    }
+    return head - tail;
+}
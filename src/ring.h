@@ -0,0 +1,58 @@
+#ifndef OS_ASSIGNMENT_20183622_RING_H
+#define OS_ASSIGNMENT_20183622_RING_H
+
+#include <stddef.h> /* For size_t. */
+
+#define CACHE_LINE 64 /* The size of a cache line, in bytes. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a bounded lock-free ring buffer.
+ *
+ * This is a multi-producer multi-consumer ring where every slot carries a
+ * sequence number. A slot can be written when its sequence equals the
+ * enqueue position, and read when it equals the dequeue position + 1, so
+ * producers and consumers only contend on their own position counter.
+ * The two positions are padded onto their own cache lines.
+ *
+ * @param head - The position of the next element to be written.
+ * @param tail - The position of the next element to be read.
+ * @param capacity - The number of slots in the ring.
+ * @param elem_size - The size of one element, in bytes.
+ * @param seq - The sequence number of each slot.
+ * @param data - The elements.
+ *************************************************************************/
+typedef struct ring {
+    char pad0[CACHE_LINE];
+    unsigned long head;
+    char pad1[CACHE_LINE - sizeof(unsigned long)];
+    unsigned long tail;
+    char pad2[CACHE_LINE - sizeof(unsigned long)];
+    unsigned long capacity;
+    size_t elem_size;
+    unsigned long *seq;
+    char *data;
+} ring_t; /* Ring buffer struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int ring_init(ring_t *r, unsigned long capacity, size_t elem_size);
+
+size_t ring_bytes(unsigned long capacity, size_t elem_size);
+
+void ring_init_at(ring_t *r, unsigned long capacity, size_t elem_size, void *mem);
+
+void ring_destroy(ring_t *r);
+
+int ring_push(ring_t *r, const void *elem);
+
+int ring_pop(ring_t *r, void *elem);
+
+unsigned long ring_count(ring_t *r);
+
+#endif /*OS_ASSIGNMENT_20183622_RING_H*/
@@ -0,0 +1,113 @@
+#include "rng.h"
+#include <math.h> /* For log(), sqrt() and cos() */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Rotate Left Function.
+ *
+ * @param x - The value to be rotated.
+ * @param k - The number of bits to rotate by, from 1 to 63.
+ * @return unsigned long - The rotated value.
+ *************************************************************************/
+static unsigned long rotl(unsigned long x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/*************************************************************************
+ * SplitMix64 Function.
+ *
+ * This function steps a SplitMix64 generator, which spreads a small seed
+ * over the whole xoshiro state.
+ *
+ * @param x - The SplitMix64 state.
+ * @return unsigned long - The next SplitMix64 output.
+ *************************************************************************/
+static unsigned long splitmix64(unsigned long *x) {
+    unsigned long z = (*x += 0x9E3779B97F4A7C15UL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    return z ^ (z >> 31);
+}
+
+/*************************************************************************
+ *                             RNG Functions                             *
+ *************************************************************************/
+
+/*************************************************************************
+ * RNG Seed Function.
+ *
+ * @param r - The generator to be seeded.
+ * @param seed - The seed. Generators with different seeds give unrelated
+ *               sequences, so a thread can be seeded with seed + index.
+ * @return void
+ *************************************************************************/
+void rng_seed(rng_t *r, unsigned long seed) {
+    int i; /* Loop counter. */
+
+    for (i = 0; i < 4; i++) {
+        r->s[i] = splitmix64(&seed);
+    }
+}
+
+/*************************************************************************
+ * RNG Next Function.
+ *
+ * @param r - The generator.
+ * @return unsigned long - The next 64 random bits.
+ *************************************************************************/
+unsigned long rng_next(rng_t *r) {
+    unsigned long *s = r->s;
+    unsigned long result = rotl(s[1] * 5, 7) * 9;
+    unsigned long t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+/*************************************************************************
+ * RNG Uniform Function.
+ *
+ * @param r - The generator.
+ * @return double - A uniform random number in [0, 1), with 53 random bits.
+ *************************************************************************/
+double rng_uniform(rng_t *r) {
+    return (rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*************************************************************************
+ * RNG Exponential Function.
+ *
+ * @param r - The generator.
+ * @param mean - The mean of the distribution.
+ * @return double - An exponentially distributed random number.
+ *************************************************************************/
+double rng_exponential(rng_t *r, double mean) {
+    return -mean * log(1.0 - rng_uniform(r));
+}
+
+/*************************************************************************
+ * RNG Normal Function.
+ *
+ * This function uses the Box-Muller transform, and draws two uniform
+ * numbers for every normal one.
+ *
+ * @param r - The generator.
+ * @return double - A normally distributed random number, with mean 0 and
+ *                  standard deviation 1.
+ *************************************************************************/
+double rng_normal(rng_t *r) {
+    double u = 1.0 - rng_uniform(r); /* In (0, 1], so the log is finite. */
+    double v = rng_uniform(r);
+
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
@@ -0,0 +1,39 @@
+#ifndef OS_ASSIGNMENT_20183622_RNG_H
+#define OS_ASSIGNMENT_20183622_RNG_H
+
+#define RNG_SEED 1 /* The default seed, so that runs are reproducible. */
+#define RNG_TELLER_STREAM 0x10000UL /* Teller generators are seeded this far from the producer ones. */
+#define RNG_ROUTE_STREAM 0x20000UL /* Router generators are seeded this far from the producer ones. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a random number generator.
+ *
+ * This is xoshiro256**, a small and fast generator with a 2^256 - 1
+ * period. Each thread keeps its own generator, so drawing a number never
+ * touches shared state. The state words are 64-bit (LP64).
+ *
+ * @param s - The state of the generator.
+ *************************************************************************/
+typedef struct rng {
+    unsigned long s[4];
+} rng_t; /* Random number generator struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+void rng_seed(rng_t *r, unsigned long seed);
+
+unsigned long rng_next(rng_t *r);
+
+double rng_uniform(rng_t *r);
+
+double rng_exponential(rng_t *r, double mean);
+
+double rng_normal(rng_t *r);
+
+#endif /*OS_ASSIGNMENT_20183622_RNG_H*/
@@ -0,0 +1,72 @@
+#include "router.h"
+#include "queue.h"
+
+/*************************************************************************
+ *                            Router Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Route Policy Function.
+ *
+ * @param name - The name of the policy ("random", "rr", "jsq" or "p2c").
+ * @return int - The policy, or -1 if the name is not known.
+ *************************************************************************/
+int route_policy(const char *name) {
+    if (strcmp(name, "random") == 0) {
+        return ROUTE_RANDOM;
+    } else if (strcmp(name, "rr") == 0) {
+        return ROUTE_ROUND_ROBIN;
+    } else if (strcmp(name, "jsq") == 0) {
+        return ROUTE_JSQ;
+    } else if (strcmp(name, "p2c") == 0) {
+        return ROUTE_P2C;
+    }
+    return -1;
+}
+
+/*************************************************************************
+ * Route Pick Function.
+ *
+ * This function chooses the branch for the next customer of a producer.
+ * Join-shortest-queue reads every depth and starts its scan at a random
+ * branch, so ties do not all go to the first one. Power-of-two-choices
+ * reads two distinct branches, which keeps most of the benefit at a
+ * fixed cost however many branches there are.
+ *
+ * @param r - The router.
+ * @param rng - The producer's generator.
+ * @param turn - The producer's round-robin position, advanced.
+ * @return int - The branch.
+ *************************************************************************/
+int route_pick(const router_t *r, rng_t *rng, unsigned long *turn) {
+    int best, depth, least, a, b, i;
+
+    if (r->branches == 1) {
+        return 0;
+    }
+
+    switch (r->policy) {
+        case ROUTE_ROUND_ROBIN:
+            return (int) ((*turn)++ % (unsigned long) r->branches);
+        case ROUTE_JSQ:
+            a = (int) (rng_next(rng) % (unsigned long) r->branches);
+            best = a;
+            least = queue_count(&r->queues[a]);
+            for (i = 1; i < r->branches && least > 0; i++) {
+                b = (a + i) % r->branches;
+                depth = queue_count(&r->queues[b]);
+                if (depth < least) {
+                    best = b;
+                    least = depth;
+                }
+            }
+            return best;
+        case ROUTE_P2C:
+            a = (int) (rng_next(rng) % (unsigned long) r->branches);
+            b = (int) (rng_next(rng) % (unsigned long) (r->branches - 1));
+            b += b >= a; /* Skip a, so the two choices differ. */
+            return queue_count(&r->queues[b]) < queue_count(&r->queues[a]) ? b : a;
+        default: /* ROUTE_RANDOM */
+            return (int) (rng_next(rng) % (unsigned long) r->branches);
+    }
+}
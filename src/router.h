@@ -0,0 +1,41 @@
+#ifndef OS_ASSIGNMENT_20183622_ROUTER_H
+#define OS_ASSIGNMENT_20183622_ROUTER_H
+
+#include "standard.h"
+#include "rng.h"
+
+#define ROUTE_RANDOM 0 /* Send each customer to a branch chosen at random. */
+#define ROUTE_ROUND_ROBIN 1 /* Send the customers to the branches in turn. */
+#define ROUTE_JSQ 2 /* Send each customer to the branch with the shortest queue. */
+#define ROUTE_P2C 3 /* Send each customer to the shorter of two branches chosen at random. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a router between the branch queues.
+ *
+ * The router itself is read-only once set up. Each producer keeps its
+ * own generator and turn, so routing takes no lock and writes no shared
+ * memory, and the queue depths are read with relaxed loads.
+ *
+ * @param policy - ROUTE_RANDOM, ROUTE_ROUND_ROBIN, ROUTE_JSQ or ROUTE_P2C.
+ * @param branches - The number of branches.
+ * @param queues - The queue of each branch.
+ *************************************************************************/
+typedef struct router {
+    int policy;
+    int branches;
+    customer_queue_t *queues;
+} router_t; /* Router struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int route_policy(const char *name);
+
+int route_pick(const router_t *r, rng_t *rng, unsigned long *turn);
+
+#endif /*OS_ASSIGNMENT_20183622_ROUTER_H*/
@@ -0,0 +1,168 @@
+#include "scheduler.h"
+
+/*************************************************************************
+ *                          Scheduler Functions                          *
+ *************************************************************************/
+
+/*************************************************************************
+ * Sched Init Function.
+ *
+ * @param s - The scheduler to be initialized.
+ * @param policy - The scheduling policy.
+ * @param size - The size/length of the customer queue (m). Each service
+ *               type's queue can hold the whole queue.
+ * @param cost - The expected service time of 'W', 'D' and 'I'.
+ * @param weight - The weight of 'W', 'D' and 'I'.
+ * @return int - 0 on success, 1 if the queues could not be allocated.
+ *************************************************************************/
+int sched_init(sched_t *s, int policy, int size, const double *cost, const double *weight) {
+    int i; /* Loop counter. */
+
+    memset(s, 0, sizeof(sched_t));
+    s->policy = policy;
+    s->size = size;
+
+    for (i = 0; i < LAT_TYPES; i++) {
+        s->cost[i] = cost[i];
+        s->weight[i] = weight[i];
+        s->q[i] = malloc(sizeof(sched_entry_t) * size);
+        if (s->q[i] == NULL) {
+            sched_destroy(s);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*************************************************************************
+ * Sched Destroy Function.
+ *
+ * @param s - The scheduler to be destroyed.
+ * @return void
+ *************************************************************************/
+void sched_destroy(sched_t *s) {
+    int i; /* Loop counter. */
+
+    for (i = 0; i < LAT_TYPES; i++) {
+        free(s->q[i]);
+        s->q[i] = NULL;
+    }
+}
+
+/*************************************************************************
+ * Sched Put Function.
+ *
+ * This function adds a customer to the back of its service type's queue.
+ * For POLICY_WFQ the customer is given a virtual finish time, which is
+ * when it would finish if every service type was served at a rate in
+ * proportion to its weight.
+ *
+ * @param s - The scheduler.
+ * @param c - The customer to be added.
+ * @return void
+ *************************************************************************/
+void sched_put(sched_t *s, const customer_t *c) {
+    int type = latency_type(c->service_type);
+    sched_entry_t *e = &s->q[type][(s->front[type] + s->count[type]) % s->size];
+    double start;
+
+    e->c = *c;
+    e->seq = s->seq++;
+
+    start = s->last_finish[type] > s->vtime ? s->last_finish[type] : s->vtime;
+    e->finish = start + s->cost[type] / s->weight[type];
+    s->last_finish[type] = e->finish;
+
+    s->count[type]++;
+}
+
+/*************************************************************************
+ * Sched Before Function.
+ *
+ * @param s - The scheduler.
+ * @param a - The service type of the first queue.
+ * @param b - The service type of the second queue.
+ * @return int - TRUE if the front customer of queue a should be served
+ *               before the front customer of queue b.
+ *************************************************************************/
+static int sched_before(const sched_t *s, int a, int b) {
+    const sched_entry_t *ea = &s->q[a][s->front[a]];
+    const sched_entry_t *eb = &s->q[b][s->front[b]];
+
+    switch (s->policy) {
+        case POLICY_SJF:
+            if (s->cost[a] != s->cost[b]) {
+                return s->cost[a] < s->cost[b];
+            }
+            break;
+        case POLICY_PRIORITY:
+            if (s->weight[a] != s->weight[b]) {
+                return s->weight[a] > s->weight[b];
+            }
+            break;
+        case POLICY_WFQ:
+            if (ea->finish != eb->finish) {
+                return ea->finish < eb->finish;
+            }
+            break;
+        default: /* POLICY_FIFO */
+            break;
+    }
+
+    /* Ties go to the customer that arrived first. */
+    return ea->seq < eb->seq;
+}
+
+/*************************************************************************
+ * Sched Get Function.
+ *
+ * This function removes the next customer chosen by the policy.
+ *
+ * @param s - The scheduler.
+ * @param c - The customer to be filled.
+ * @return int - TRUE if a customer was removed, FALSE if all the queues
+ *               are empty.
+ *************************************************************************/
+int sched_get(sched_t *s, customer_t *c) {
+    int best = -1;
+    int i; /* Loop counter. */
+
+    for (i = 0; i < LAT_TYPES; i++) {
+        if (s->count[i] > 0 && (best < 0 || sched_before(s, i, best))) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return FALSE;
+    }
+
+    *c = s->q[best][s->front[best]].c;
+    s->vtime = s->q[best][s->front[best]].finish;
+    s->front[best] = (s->front[best] + 1) % s->size;
+    s->count[best]--;
+
+    return TRUE;
+}
+
+/*************************************************************************
+ * Sched Policy Function.
+ *
+ * This function converts the name of a scheduling policy, as given on the
+ * command line, to its value.
+ *
+ * @param name - The name of the policy ("fifo", "sjf", "priority" or "wfq").
+ * @return int - The policy, or -1 if the name is not known.
+ *************************************************************************/
+int sched_policy(const char *name) {
+    if (strcmp(name, "fifo") == 0) {
+        return POLICY_FIFO;
+    } else if (strcmp(name, "sjf") == 0) {
+        return POLICY_SJF;
+    } else if (strcmp(name, "priority") == 0) {
+        return POLICY_PRIORITY;
+    } else if (strcmp(name, "wfq") == 0) {
+        return POLICY_WFQ;
+    }
+    return -1;
+}
@@ -0,0 +1,73 @@
+#ifndef OS_ASSIGNMENT_20183622_SCHEDULER_H
+#define OS_ASSIGNMENT_20183622_SCHEDULER_H
+
+#include "standard.h"
+
+#define POLICY_FIFO 0 /* Serve the customer that arrived first. */
+#define POLICY_SJF 1 /* Serve the service type with the shortest expected service time first. */
+#define POLICY_PRIORITY 2 /* Serve the service type with the highest weight first. */
+#define POLICY_WFQ 3 /* Share the tellers between the service types in proportion to their weights. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a customer waiting in a scheduler.
+ *
+ * @param c - The customer.
+ * @param seq - The order the customer arrived in.
+ * @param finish - The virtual finish time of the customer (POLICY_WFQ).
+ *************************************************************************/
+typedef struct sched_entry {
+    customer_t c;
+    unsigned long seq;
+    double finish;
+} sched_entry_t; /* Scheduler entry struct. */
+
+/*************************************************************************
+ * Struct for a scheduler.
+ *
+ * The waiting customers are kept in a FIFO queue per service type, and
+ * the policy decides which queue the next customer is taken from. The
+ * scheduler does no locking of its own.
+ *
+ * @param policy - The scheduling policy.
+ * @param size - The capacity of each service type's queue.
+ * @param q - The queue of each service type.
+ * @param front - The position of the front customer of each queue.
+ * @param count - The number of customers in each queue.
+ * @param seq - The sequence number of the next customer.
+ * @param vtime - The virtual time, the finish time of the last customer taken (POLICY_WFQ).
+ * @param last_finish - The finish time of the last customer added to each queue (POLICY_WFQ).
+ * @param cost - The expected service time of each service type.
+ * @param weight - The weight of each service type.
+ *************************************************************************/
+typedef struct sched {
+    int policy;
+    int size;
+    sched_entry_t *q[LAT_TYPES];
+    int front[LAT_TYPES];
+    int count[LAT_TYPES];
+    unsigned long seq;
+    double vtime;
+    double last_finish[LAT_TYPES];
+    double cost[LAT_TYPES];
+    double weight[LAT_TYPES];
+} sched_t; /* Scheduler struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int sched_init(sched_t *s, int policy, int size, const double *cost, const double *weight);
+
+void sched_destroy(sched_t *s);
+
+void sched_put(sched_t *s, const customer_t *c);
+
+int sched_get(sched_t *s, customer_t *c);
+
+int sched_policy(const char *name);
+
+#endif /*OS_ASSIGNMENT_20183622_SCHEDULER_H*/
@@ -0,0 +1,161 @@
+#include "service.h"
+#include <math.h> /* For log() and exp() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SERVICE_LINE 256 /* The longest line read from an empirical distribution file. */
+
+/*************************************************************************
+ *                           Service Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Service Parse Function.
+ *
+ * This function reads a service time distribution as given on the command
+ * line, e.g. "W:exp", "D:lognormal", "D:lognormal:1.5", "I:fixed" or
+ * "I:empirical:times.csv". The distribution is set up by service_init()
+ * once the mean service time is known.
+ *
+ * @param arg - The argument. It must live as long as the distribution,
+ *              as the file name is not copied.
+ * @param service_type - Filled with the service type, 'W', 'D' or 'I'.
+ * @param s - Filled with the distribution.
+ * @return int - 0 on success, 1 if the argument is not valid.
+ *************************************************************************/
+int service_parse(const char *arg, char *service_type, service_t *s) {
+    const char *name = arg + 2; /* The distribution, after "T:". */
+    const char *param; /* The parameter of the distribution, if any. */
+    size_t len; /* The length of the distribution name. */
+    char *end; /* The end of the parameter read. */
+
+    if (strlen(arg) < 3 || strchr("WDI", arg[0]) == NULL || arg[1] != ':') {
+        return 1;
+    }
+    *service_type = arg[0];
+
+    param = strchr(name, ':');
+    len = param == NULL ? strlen(name) : (size_t) (param - name);
+    if (param != NULL) {
+        param++;
+    }
+
+    memset(s, 0, sizeof(service_t));
+    if (len == 5 && strncmp(name, "fixed", len) == 0 && param == NULL) {
+        s->kind = SERVICE_FIXED;
+    } else if (len == 3 && strncmp(name, "exp", len) == 0 && param == NULL) {
+        s->kind = SERVICE_EXPONENTIAL;
+    } else if (len == 9 && strncmp(name, "lognormal", len) == 0) {
+        s->kind = SERVICE_LOGNORMAL;
+        s->sigma = SERVICE_SIGMA;
+        if (param != NULL) {
+            s->sigma = strtod(param, &end);
+            if (end == param || *end != '\0' || s->sigma <= 0) {
+                return 1;
+            }
+        }
+    } else if (len == 9 && strncmp(name, "empirical", len) == 0 && param != NULL && *param != '\0') {
+        s->kind = SERVICE_EMPIRICAL;
+        s->file = param;
+    } else {
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Service Init Function.
+ *
+ * This function scales the distribution to the mean service time, or
+ * reads the samples of an empirical distribution. An empirical file holds
+ * one service time in seconds at the start of each line; lines that do
+ * not start with a number, like a CSV header, are skipped.
+ *
+ * @param s - The distribution, zeroed or filled by service_parse().
+ * @param mean - The mean service time, in seconds.
+ * @return int - 0 on success, 1 if the samples could not be read.
+ *************************************************************************/
+int service_init(service_t *s, int mean) {
+    char line[SERVICE_LINE];
+    char *end; /* The end of the number read from a line. */
+    double value; /* A service time read from the file, in seconds. */
+    double total = 0; /* The total of the samples, in ns. */
+    int size = 0; /* The number of samples there is room for. */
+    long *grown;
+    FILE *f;
+
+    s->mean = (double) mean * 1e9;
+    if (s->kind == SERVICE_LOGNORMAL) {
+        /* E[X] = exp(mu + sigma^2 / 2), so this keeps the mean. */
+        s->mu = log(s->mean) - s->sigma * s->sigma / 2;
+    }
+    if (s->kind != SERVICE_EMPIRICAL) {
+        return 0;
+    }
+
+    f = fopen(s->file, "r");
+    if (f == NULL) {
+        printf("Error: Failed to open the service time file %s.\n", s->file);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        value = strtod(line, &end);
+        if (end == line || value < 0) {
+            continue;
+        }
+        if (s->n_samples == size) {
+            size = size == 0 ? 1024 : size * 2;
+            grown = realloc(s->samples, sizeof(long) * size);
+            if (grown == NULL) {
+                printf("Error: Failed to allocate the service times.\n");
+                fclose(f);
+                return 1;
+            }
+            s->samples = grown;
+        }
+        s->samples[s->n_samples] = (long) (value * 1e9);
+        total += s->samples[s->n_samples];
+        s->n_samples++;
+    }
+    fclose(f);
+
+    if (s->n_samples == 0) {
+        printf("Error: The service time file %s holds no service times.\n", s->file);
+        return 1;
+    }
+    s->mean = total / s->n_samples;
+    return 0;
+}
+
+/*************************************************************************
+ * Service Destroy Function.
+ *
+ * @param s - The distribution to be destroyed.
+ * @return void
+ *************************************************************************/
+void service_destroy(service_t *s) {
+    free(s->samples);
+    s->samples = NULL;
+    s->n_samples = 0;
+}
+
+/*************************************************************************
+ * Service Sample Function.
+ *
+ * @param s - The distribution.
+ * @param r - The generator of the thread drawing the sample.
+ * @return long - A service time, in ns.
+ *************************************************************************/
+long service_sample(const service_t *s, rng_t *r) {
+    switch (s->kind) {
+        case SERVICE_EXPONENTIAL:
+            return (long) rng_exponential(r, s->mean);
+        case SERVICE_LOGNORMAL:
+            return (long) exp(s->mu + s->sigma * rng_normal(r));
+        case SERVICE_EMPIRICAL:
+            return s->samples[(int) (rng_uniform(r) * s->n_samples)];
+        default: /* SERVICE_FIXED */
+            return (long) s->mean;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef OS_ASSIGNMENT_20183622_SERVICE_H
+#define OS_ASSIGNMENT_20183622_SERVICE_H
+
+#include "rng.h"
+
+#define SERVICE_FIXED 0 /* Every customer takes the mean time. */
+#define SERVICE_EXPONENTIAL 1 /* Exponential service times with the mean time. */
+#define SERVICE_LOGNORMAL 2 /* Lognormal service times with the mean time. */
+#define SERVICE_EMPIRICAL 3 /* Service times drawn from the samples in a file. */
+#define SERVICE_SIGMA 1.0 /* The default lognormal shape; the p99 is about 4x the mean. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for the service time distribution of one service type.
+ *
+ * The fixed, exponential and lognormal distributions are scaled to the
+ * service time given on the command line (t_W, t_D or t_I), so changing
+ * the distribution changes the spread of the times but not their mean.
+ * An empirical distribution takes its times and mean from its file.
+ *
+ * @param kind - SERVICE_FIXED, SERVICE_EXPONENTIAL, SERVICE_LOGNORMAL or
+ *               SERVICE_EMPIRICAL.
+ * @param mean - The mean service time, in ns.
+ * @param mu - The mean of the log of a lognormal service time, in log ns.
+ * @param sigma - The standard deviation of the log of a lognormal service time.
+ * @param file - The file of an empirical distribution.
+ * @param samples - The service times read from the file, in ns.
+ * @param n_samples - The number of samples.
+ *************************************************************************/
+typedef struct service {
+    int kind;
+    double mean;
+    double mu;
+    double sigma;
+    const char *file;
+    long *samples;
+    int n_samples;
+} service_t; /* Service time distribution struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int service_parse(const char *arg, char *service_type, service_t *s);
+
+int service_init(service_t *s, int mean);
+
+void service_destroy(service_t *s);
+
+long service_sample(const service_t *s, rng_t *r);
+
+#endif /*OS_ASSIGNMENT_20183622_SERVICE_H*/
@@ -0,0 +1,194 @@
+#include "standard.h"
+#include "shm.h"
+#include <fcntl.h> /* For O_CREAT */
+#include <sys/mman.h> /* For shm_open() and mmap() */
+#include <sys/stat.h> /* For fstat() */
+
+/*************************************************************************
+ *                     Shared Memory Segment Functions                   *
+ *************************************************************************/
+
+/*************************************************************************
+ * Shared Memory Create Function.
+ *
+ * This function creates a segment named /bank-<pid>-<tag> and maps it.
+ * The name is removed as soon as the segment is mapped: the processes
+ * that share it are forked from this one and inherit the mapping, and the
+ * memory is freed once the last of them exits, even if one crashes.
+ *
+ * @param s - The segment to be created.
+ * @param tag - What the segment holds, for its name.
+ * @param size - The size of the segment, in bytes.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int shm_create(shm_t *s, const char *tag, size_t size) {
+    void *base;
+    int fd;
+
+    memset(s, 0, sizeof(shm_t));
+    sprintf(s->name, "/bank-%ld-%.32s", (long) getpid(), tag);
+    fd = shm_open(s->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        printf("Error: Failed to create the shared memory segment %s.\n", s->name);
+        return 1;
+    }
+    if (ftruncate(fd, (off_t) size) != 0) {
+        printf("Error: Failed to size the shared memory segment %s to %lu bytes.\n", s->name, (unsigned long) size);
+        close(fd);
+        shm_unlink(s->name);
+        return 1;
+    }
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(s->name);
+    if (base == MAP_FAILED) {
+        printf("Error: Failed to map the shared memory segment %s.\n", s->name);
+        return 1;
+    }
+    s->base = base;
+    s->size = size;
+    return 0;
+}
+
+/*************************************************************************
+ * Shared Memory Alloc Function.
+ *
+ * @param s - The segment.
+ * @param size - The number of bytes wanted.
+ * @return void* - The memory, zeroed and aligned to a cache line, or NULL
+ *                 if the segment is full.
+ *************************************************************************/
+void *shm_alloc(shm_t *s, size_t size) {
+    void *p;
+
+    if (s->used + size > s->size) {
+        return NULL;
+    }
+    p = s->base + s->used;
+    s->used += (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    return p;
+}
+
+/*************************************************************************
+ * Shared Memory Destroy Function.
+ *
+ * @param s - The segment to be unmapped. Everything allocated from it is
+ *            gone.
+ * @return void
+ *************************************************************************/
+void shm_destroy(shm_t *s) {
+    if (s->base != NULL) {
+        munmap(s->base, s->size);
+    }
+    s->base = NULL;
+    s->size = 0;
+    s->used = 0;
+}
+
+/*************************************************************************
+ * Shared Memory Name Function.
+ *
+ * @param s - The segment.
+ * @param name - The name given by the user, with or without the leading
+ *               '/' that shm_open() wants.
+ * @return void
+ *************************************************************************/
+static void shm_name(shm_t *s, const char *name) {
+    sprintf(s->name, "%s%.60s", name[0] == '/' ? "" : "/", name);
+}
+
+/*************************************************************************
+ * Shared Memory Publish Function.
+ *
+ * This function creates a segment under a name that other programs can
+ * open with shm_attach(), and maps it. Unlike shm_create() the name is
+ * kept until shm_remove() is called. A segment left under the name by an
+ * earlier run is replaced.
+ *
+ * @param s - The segment to be created.
+ * @param name - The name of the segment.
+ * @param size - The size of the segment, in bytes.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int shm_publish(shm_t *s, const char *name, size_t size) {
+    void *base;
+    int fd;
+
+    memset(s, 0, sizeof(shm_t));
+    shm_name(s, name);
+    shm_unlink(s->name);
+    fd = shm_open(s->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("Error: Failed to create the shared memory segment %s.\n", s->name);
+        return 1;
+    }
+    if (ftruncate(fd, (off_t) size) != 0) {
+        printf("Error: Failed to size the shared memory segment %s to %lu bytes.\n", s->name, (unsigned long) size);
+        close(fd);
+        shm_unlink(s->name);
+        return 1;
+    }
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Error: Failed to map the shared memory segment %s.\n", s->name);
+        shm_unlink(s->name);
+        return 1;
+    }
+    s->base = base;
+    s->size = size;
+    return 0;
+}
+
+/*************************************************************************
+ * Shared Memory Attach Function.
+ *
+ * This function maps, read-only, a segment another process created with
+ * shm_publish(). Nothing can be allocated from it.
+ *
+ * @param s - The segment to be attached.
+ * @param name - The name of the segment.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int shm_attach(shm_t *s, const char *name) {
+    struct stat st;
+    void *base;
+    int fd;
+
+    memset(s, 0, sizeof(shm_t));
+    shm_name(s, name);
+    fd = shm_open(s->name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Error: There is no shared memory segment %s.\n", s->name);
+        return 1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Error: The shared memory segment %s is empty.\n", s->name);
+        close(fd);
+        return 1;
+    }
+    base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Error: Failed to map the shared memory segment %s.\n", s->name);
+        return 1;
+    }
+    s->base = base;
+    s->size = (size_t) st.st_size;
+    s->used = s->size;
+    return 0;
+}
+
+/*************************************************************************
+ * Shared Memory Remove Function.
+ *
+ * This function removes the name of a published segment, so no one else
+ * can attach to it. The processes that have it mapped keep it until they
+ * call shm_destroy().
+ *
+ * @param s - The segment.
+ * @return void
+ *************************************************************************/
+void shm_remove(shm_t *s) {
+    shm_unlink(s->name);
+}
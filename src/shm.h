@@ -0,0 +1,47 @@
+#ifndef OS_ASSIGNMENT_20183622_SHM_H
+#define OS_ASSIGNMENT_20183622_SHM_H
+
+#include <stddef.h> /* For size_t. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a shared memory segment.
+ *
+ * The segment is created with shm_open() and mapped MAP_SHARED before the
+ * teller processes are forked, so it is at the same address in every
+ * process and the pointers stored in it stay valid. Memory is handed out
+ * from the front of the segment and only given back when the whole
+ * segment is destroyed.
+ *
+ * @param name - The name the segment was created under.
+ * @param base - The start of the mapping.
+ * @param size - The size of the segment, in bytes.
+ * @param used - The number of bytes handed out.
+ *************************************************************************/
+typedef struct shm {
+    char name[64];
+    char *base;
+    size_t size;
+    size_t used;
+} shm_t; /* Shared memory segment struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int shm_create(shm_t *s, const char *tag, size_t size);
+
+void *shm_alloc(shm_t *s, size_t size);
+
+void shm_destroy(shm_t *s);
+
+int shm_publish(shm_t *s, const char *name, size_t size);
+
+int shm_attach(shm_t *s, const char *name);
+
+void shm_remove(shm_t *s);
+
+#endif /*OS_ASSIGNMENT_20183622_SHM_H*/
@@ -0,0 +1,414 @@
+#include "sim.h"
+#include "ingest.h"
+#include "scheduler.h"
+
+/*************************************************************************
+ *                            Macro Definitions                          *
+ *************************************************************************/
+
+#define EV_ARRIVAL 0 /* The next customer arrives. */
+#define EV_COMPLETION 1 /* A teller finishes serving a customer. */
+#define EV_END 2 /* The customer thread reaches the end of the file. */
+#define NS 1000000000L /* The number of nanoseconds in a second. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a simulation event.
+ *
+ * Events are ordered by time, and events at the same time are ordered by
+ * the sequence they were scheduled in so that a run is deterministic.
+ *
+ * @param time - The virtual time of the event, in nanoseconds.
+ * @param seq - The order the event was scheduled in.
+ * @param type - The event type (EV_ARRIVAL, EV_COMPLETION or EV_END).
+ * @param teller - The index of the teller, for EV_COMPLETION events.
+ *************************************************************************/
+typedef struct sim_event {
+    long time;
+    long seq;
+    int type;
+    int teller;
+} sim_event_t; /* Simulation event struct. */
+
+/*************************************************************************
+ * Struct for the state of one simulation.
+ *
+ * @param cfg - The configuration of the run.
+ * @param tellers - The array of tellers being simulated.
+ * @param events - The event queue, stored as a binary min-heap.
+ * @param n_events - The number of events in the event queue.
+ * @param seq - The sequence number of the next scheduled event.
+ * @param q - The customer queue, with a queue per service type.
+ * @param count - The number of customers in the queue.
+ * @param serving - The customer each teller is serving.
+ * @param response - The time each teller took the customer it is serving.
+ * @param rng - The generator for the service times of each teller.
+ * @param busy - TRUE for each teller that is serving a customer.
+ * @param done - TRUE for each teller that has terminated.
+ * @param reader - The customer file reader.
+ * @param blocked - TRUE if the customer thread is waiting on a full queue.
+ * @param pending - The next customer to arrive, read ahead from the file.
+ * @param schedule - The open-loop arrival schedule, when cfg->rate is set.
+ * @param timed - TRUE if the last customer read had an arrival time.
+ * @param end_of_file - TRUE once the customer file has been read.
+ * @param base - The CLOCK_MONOTONIC time that virtual time 0 is mapped to.
+ *************************************************************************/
+typedef struct sim_state {
+    const sim_config_t *cfg;
+    teller_t *tellers;
+    sim_event_t *events;
+    int n_events;
+    long seq;
+    sched_t q;
+    int count;
+    customer_t *serving;
+    long *response;
+    rng_t *rng;
+    int *busy;
+    int *done;
+    ingest_t reader;
+    int blocked;
+    customer_t pending;
+    arrival_t schedule;
+    int timed;
+    int end_of_file;
+    long base;
+} sim_state_t; /* Simulation state struct. */
+
+/*************************************************************************
+ *                          Event Queue Functions                        *
+ *************************************************************************/
+
+/*************************************************************************
+ * Event Before Function.
+ *
+ * @param a - The first event.
+ * @param b - The second event.
+ * @return int - TRUE if a should be processed before b, FALSE otherwise.
+ *************************************************************************/
+static int event_before(const sim_event_t *a, const sim_event_t *b) {
+    if (a->time != b->time) {
+        return a->time < b->time;
+    }
+    return a->seq < b->seq;
+}
+
+/*************************************************************************
+ * Schedule Event Function.
+ *
+ * This function adds an event to the event queue. The queue never holds
+ * more than one arrival and one completion per teller, so it is sized
+ * once when the simulation starts.
+ *
+ * @param s - The simulation state.
+ * @param time - The virtual time of the event.
+ * @param type - The event type.
+ * @param teller - The index of the teller, for EV_COMPLETION events.
+ * @return void
+ *************************************************************************/
+static void schedule(sim_state_t *s, long time, int type, int teller) {
+    int i = s->n_events++;
+    sim_event_t ev;
+
+    ev.time = time;
+    ev.seq = s->seq++;
+    ev.type = type;
+    ev.teller = teller;
+
+    /* Sift the new event up the heap. */
+    while (i > 0 && event_before(&ev, &s->events[(i - 1) / 2])) {
+        s->events[i] = s->events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s->events[i] = ev;
+}
+
+/*************************************************************************
+ * Next Event Function.
+ *
+ * This function removes the earliest event from the event queue.
+ *
+ * @param s - The simulation state.
+ * @param ev - The event to be filled.
+ * @return int - TRUE if an event was removed, FALSE if the queue is empty.
+ *************************************************************************/
+static int next_event(sim_state_t *s, sim_event_t *ev) {
+    sim_event_t last;
+    int i = 0;
+    int child;
+
+    if (s->n_events == 0) {
+        return FALSE;
+    }
+
+    *ev = s->events[0];
+    last = s->events[--s->n_events];
+
+    /* Sift the last event down from the root. */
+    while ((child = 2 * i + 1) < s->n_events) {
+        if (child + 1 < s->n_events && event_before(&s->events[child + 1], &s->events[child])) {
+            child++;
+        }
+        if (!event_before(&s->events[child], &last)) {
+            break;
+        }
+        s->events[i] = s->events[child];
+        i = child;
+    }
+    s->events[i] = last;
+
+    return TRUE;
+}
+
+/*************************************************************************
+ *                         Simulation Functions                          *
+ *************************************************************************/
+
+/*************************************************************************
+ * Terminate Teller Function.
+ *
+ * @param s - The simulation state.
+ * @param i - The index of the teller.
+ * @param now - The current virtual time.
+ * @return void
+ *************************************************************************/
+static void terminate(sim_state_t *s, int i, long now) {
+    s->done[i] = TRUE;
+    s->tellers[i].end_time = s->base + now;
+    if (s->cfg->log) {
+        log_termination(&s->tellers[i]);
+    }
+}
+
+/*************************************************************************
+ * Read Next Function.
+ *
+ * This function reads the next customer from the customer file and
+ * schedules its arrival, either k * t_C after the start for the k-th
+ * customer of the file, as the customer threads schedule it, at the
+ * arrival time on its line, or at the next time of the open-loop
+ * schedule. A customer the
+ * customer thread could not add on time keeps the time it was meant to
+ * arrive as its intended_time. At the end of the file it schedules the
+ * end of the input.
+ *
+ * @param s - The simulation state.
+ * @param now - The current virtual time.
+ * @return void
+ *************************************************************************/
+static void read_next(sim_state_t *s, long now) {
+    long at;
+
+    if (ingest_next(&s->reader, &s->pending, &at) == FALSE) {
+        /* Without arrival times, the end of the file is only seen after one more period. */
+        at = (s->reader.index + 1) * s->cfg->t_C * NS;
+        schedule(s, s->timed || at < now ? now : at, EV_END, 0);
+        return;
+    }
+
+    if (s->cfg->rate > 0) {
+        at = arrival_next(&s->schedule);
+    }
+    s->timed = at >= 0;
+    if (at < 0) {
+        at = s->reader.index * s->cfg->t_C * NS;
+    }
+    s->pending.intended_time = s->base + at;
+    if (at < now) {
+        at = now; /* The customer thread is late, because the queue was full. */
+    }
+    schedule(s, at, EV_ARRIVAL, 0);
+}
+
+static void enqueue(sim_state_t *s, customer_t *c, long now);
+
+/*************************************************************************
+ * Take Customer Function.
+ *
+ * This function has teller i take the customer at the front of the queue
+ * and schedules the completion of its service. If the customer thread was
+ * blocked on a full queue, it is woken up.
+ *
+ * @param s - The simulation state.
+ * @param i - The index of the teller.
+ * @param now - The current virtual time.
+ * @return void
+ *************************************************************************/
+static void take(sim_state_t *s, int i, long now) {
+    sched_get(&s->q, &s->serving[i]);
+    s->count--;
+    s->busy[i] = TRUE;
+    s->response[i] = now;
+
+    if (s->cfg->log) {
+        log_response(&s->tellers[i], &s->serving[i], s->base + now);
+    }
+
+    schedule(s, now + service_sample(&s->cfg->service[latency_type(s->serving[i].service_type)], &s->rng[i]),
+             EV_COMPLETION, i);
+
+    /* The queue is no longer full, so the customer thread can continue. */
+    if (s->blocked == TRUE) {
+        s->blocked = FALSE;
+        enqueue(s, &s->pending, now);
+        read_next(s, now);
+    }
+}
+
+/*************************************************************************
+ * Enqueue Function.
+ *
+ * This function adds a customer to the queue, and hands it to the first
+ * idle teller if there is one.
+ *
+ * @param s - The simulation state.
+ * @param c - The customer that arrived.
+ * @param now - The current virtual time.
+ * @return void
+ *************************************************************************/
+static void enqueue(sim_state_t *s, customer_t *c, long now) {
+    int i; /* Loop counter. */
+
+    c->arrival_time = s->base + now;
+    sched_put(&s->q, c);
+    s->count++;
+
+    if (s->cfg->log) {
+        log_arrival(c);
+    }
+
+    for (i = 0; i < s->cfg->tellers; i++) {
+        if (s->busy[i] == FALSE && s->done[i] == FALSE) {
+            take(s, i, now);
+            break;
+        }
+    }
+}
+
+/*************************************************************************
+ * Release Function.
+ *
+ * This function frees what simulate() allocated, including whatever was
+ * allocated before an allocation failed.
+ *
+ * @param s - The simulation state.
+ * @return void
+ *************************************************************************/
+static void release(sim_state_t *s) {
+    ingest_close(&s->reader);
+    free(s->events);
+    sched_destroy(&s->q);
+    free(s->serving);
+    free(s->response);
+    free(s->rng);
+    free(s->busy);
+    free(s->done);
+}
+
+/*************************************************************************
+ * Simulate Function.
+ *
+ * This function runs the bank on a virtual clock driven by an event
+ * queue instead of sleeping. The customer arrivals and the teller service
+ * times follow the same rules as the threaded mode, and the log file is
+ * written in the same format with times taken from the virtual clock.
+ *
+ * @param cfg - The configuration of the run.
+ * @param tellers - The array of cfg->tellers tellers to be filled in. The
+ *                  latencies are recorded for tellers with a latency set.
+ * @return int - 0 on success, 1 if the customer file could not be read
+ *               or the simulation could not be allocated.
+ *************************************************************************/
+int simulate(const sim_config_t *cfg, teller_t *tellers) {
+    sim_state_t s;
+    sim_event_t ev;
+    double cost[LAT_TYPES]; /* The expected service time of 'W', 'D' and 'I'. */
+    int i; /* Loop counter. */
+
+    memset(&s, 0, sizeof(s));
+    if (ingest_open(&s.reader, cfg->customer_file) != 0) {
+        printf("Error opening file.\n");
+        return 1;
+    }
+
+    s.cfg = cfg;
+    s.tellers = tellers;
+    s.base = now_ns();
+    for (i = 0; i < LAT_TYPES; i++) {
+        cost[i] = cfg->service[i].mean / 1e9;
+    }
+    if (sched_init(&s.q, cfg->policy, cfg->queue_size, cost, cfg->weight) != 0) {
+        printf("Error: Failed to allocate the customer queue.\n");
+        release(&s);
+        return 1;
+    }
+    s.events = malloc(sizeof(sim_event_t) * (cfg->tellers + 1));
+    s.serving = malloc(sizeof(customer_t) * cfg->tellers);
+    s.response = malloc(sizeof(long) * cfg->tellers);
+    s.rng = malloc(sizeof(rng_t) * cfg->tellers);
+    s.busy = calloc(cfg->tellers, sizeof(int));
+    s.done = calloc(cfg->tellers, sizeof(int));
+    if (s.events == NULL || s.serving == NULL || s.response == NULL || s.rng == NULL || s.busy == NULL
+        || s.done == NULL) {
+        printf("Error: Failed to allocate the simulation.\n");
+        release(&s);
+        return 1;
+    }
+
+    for (i = 0; i < cfg->tellers; i++) {
+        tellers[i].teller_number = i + 1;
+        tellers[i].customers_served = 0;
+        tellers[i].start_time = s.base;
+        rng_seed(&s.rng[i], cfg->seed + RNG_TELLER_STREAM + i);
+    }
+
+    /* Schedule the arrival of the first customer. */
+    if (cfg->rate > 0) {
+        arrival_init(&s.schedule, cfg->spacing, cfg->rate, 0, 1, cfg->seed);
+    }
+    read_next(&s, 0);
+
+    while (next_event(&s, &ev) == TRUE) {
+        if (ev.type == EV_ARRIVAL) {
+            if (s.count == cfg->queue_size) {
+                /* Wait for a teller to free a slot. */
+                s.blocked = TRUE;
+            } else {
+                enqueue(&s, &s.pending, ev.time);
+                read_next(&s, ev.time);
+            }
+        } else if (ev.type == EV_END) {
+            /* The end of the file has been reached, so the idle tellers shut down. */
+            s.end_of_file = TRUE;
+            for (i = 0; i < cfg->tellers; i++) {
+                if (s.busy[i] == FALSE && s.done[i] == FALSE) {
+                    terminate(&s, i, ev.time);
+                }
+            }
+        } else { /* ev.type == EV_COMPLETION */
+            i = ev.teller;
+            s.busy[i] = FALSE;
+            tellers[i].customers_served++;
+            if (tellers[i].latency != NULL) {
+                latency_record(tellers[i].latency, s.serving[i].service_type, s.serving[i].intended_time,
+                               s.serving[i].arrival_time, s.base + s.response[i], s.base + ev.time);
+            }
+
+            if (cfg->log) {
+                log_completion(&tellers[i], &s.serving[i], s.base + ev.time);
+            }
+
+            if (s.count > 0) {
+                take(&s, i, ev.time);
+            } else if (s.end_of_file == TRUE) {
+                terminate(&s, i, ev.time);
+            }
+        }
+    }
+
+    release(&s);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef OS_ASSIGNMENT_20183622_SIM_H
+#define OS_ASSIGNMENT_20183622_SIM_H
+
+#include "standard.h"
+#include "arrival.h"
+#include "service.h"
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a simulation configuration.
+ *
+ * This struct contains everything a virtual-time run needs, so that a
+ * simulation does not depend on the globals used by the threaded mode.
+ *
+ * @param queue_size - The size/length of the customer queue (m).
+ * @param tellers - The number of tellers to simulate.
+ * @param t_C - The customer arrival period.
+ * @param service - The service time distributions of 'W', 'D' and 'I',
+ *                  set up with service_init().
+ * @param customer_file - The name of the customer file.
+ * @param log - TRUE if the run should be written to the log file.
+ * @param policy - The scheduling policy for the waiting customers.
+ * @param weight - The weight of 'W', 'D' and 'I' for the scheduling policy.
+ * @param rate - The open-loop arrival rate per second, or 0 to use t_C and
+ *               the arrival times in the file.
+ * @param spacing - The spacing of the open-loop arrivals.
+ * @param seed - The seed of the open-loop arrival schedule and the
+ *               service times.
+ *************************************************************************/
+typedef struct sim_config {
+    int queue_size;
+    int tellers;
+    int t_C;
+    service_t service[LAT_TYPES];
+    const char *customer_file;
+    int log;
+    int policy;
+    double weight[LAT_TYPES];
+    double rate;
+    int spacing;
+    unsigned long seed;
+} sim_config_t; /* Simulation configuration struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int simulate(const sim_config_t *cfg, teller_t *tellers);
+
+#endif /*OS_ASSIGNMENT_20183622_SIM_H*/
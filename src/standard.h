@@ -1,112 +1,236 @@
-
-#ifndef OS_ASSIGNMENT_20183622_STANDARD_H
-#define OS_ASSIGNMENT_20183622_STANDARD_H
-
-#include <stdlib.h>
-#include <stdio.h>
-#include <pthread.h>
-#include <unistd.h> /* For sleep() */
-#include <string.h>
-#include <signal.h> /* To catch ctrl+c */
-#include <time.h> /* For time() */
-
-#define TRUE 1
-#define FALSE 0
-
-/* If DEBUG is defined, then the program will print out debug messages by setting it to 1, if not defined DEBUG will be set to FALSE  */
-#ifdef DEBUG
-#undef DEBUG
-#define DEBUG TRUE
-#else
-#define DEBUG FALSE
-#endif
-
-
-/*************************************************************************
- *                                Structs                                *
- *************************************************************************/
-
-/*************************************************************************
- * Struct for a teller.
- *
- * This struct contains the teller number, the number of customers served
- * by the teller, the time the teller thread started, and the time the
- * teller thread ended.
- *
- * @param teller_number - The teller number.
- * @param customers_served - The number of customers served by the teller.
- * @param start_time - The time the teller thread started.
- * @param end_time - The time the teller thread ended.
- *************************************************************************/
-typedef struct teller {
-    int teller_number;
-    int customers_served;
-    char start_time[9];
-    char end_time[9];
-} teller_t; /* Teller struct. */
-
-/*************************************************************************
- * Struct for a customer.
- *
- * This struct contains the customer number, the service type, the time
- * the customer arrived in the queue, and the time the customer was
- * finished being served by a teller.
- *
- * @param customer_number - The customer number.
- * @param service_type - The service type.
- * @param arrival_time - The time the customer arrived in the queue.
- *************************************************************************/
-typedef struct customer {
-    int customer_number;
-    char service_type;
-    char arrival_time[9];
-} customer_t; /* Customer struct. */
-
-/*************************************************************************
- * Struct for a customer queue.
- *
- * This struct contains the customer queue, the size of the queue, the
- * number of customers in the queue, the position to insert the next
- * customer, and the position to remove the next customer.
- *
- * @param c_queue - The customer queue.
- * @param c_queue.size - The size of the queue.
- * @param c_queue.count - The number of customers in the queue.
- * @param c_queue.in - The position to insert the next customer.
- * @param c_queue.out - The position to remove the next customer.
- *************************************************************************/
-typedef struct customer_queue {
-    customer_t *q;
-    int size;
-    int count;
-    int in;
-    int out;
-    pthread_mutex_t mutex;
-    pthread_cond_t empty;
-    pthread_cond_t full;
-} customer_queue_t; /* Customer queue struct. */
-
-/*************************************************************************
-*                          Function Prototypes                          *
-*************************************************************************/
-
-/* Helper functions. */
-void wrt_log(const char *msg);
-
-void debug(const char *msg);
-
-void get_time(char *time_str);
-
-int is_empty();
-
-int is_full();
-
-void sig_handler(int signo);
-
-/* Thread functions. */
-void *teller(void *arg);
-
-void *customer(void *arg);
-
-
-#endif /*OS_ASSIGNMENT_20183622_STANDARD_H*/
+
+#ifndef OS_ASSIGNMENT_20183622_STANDARD_H
+#define OS_ASSIGNMENT_20183622_STANDARD_H
+
+/* Expose the POSIX interfaces (localtime_r(), getopt()) while compiling as c89. */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h> /* For sleep() */
+#include <string.h>
+#include <signal.h> /* To catch ctrl+c */
+#include <time.h> /* For time() */
+#include <sys/wait.h> /* For waitpid() */
+#include "ring.h"
+#include "hist.h"
+#include "wait.h"
+
+#define TRUE 1
+#define FALSE 0
+#define MSG_LEN 256 /* The size of a formatted log message. */
+
+/* If DEBUG is defined, then the program will print out debug messages by setting it to 1, if not defined DEBUG will be set to FALSE  */
+#ifdef DEBUG
+#undef DEBUG
+#define DEBUG TRUE
+#else
+#define DEBUG FALSE
+#endif
+
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a teller.
+ *
+ * This struct contains the teller number, the number of customers served
+ * by the teller, the time the teller thread started, and the time the
+ * teller thread ended.
+ *
+ * @param teller_number - The teller number.
+ * @param customers_served - The number of customers served by the teller.
+ * @param start_time - The CLOCK_MONOTONIC time the teller thread started, in ns.
+ * @param end_time - The CLOCK_MONOTONIC time the teller thread ended, in ns.
+ * @param latency - The latencies of the customers served by the teller.
+ *************************************************************************/
+typedef struct teller {
+    int teller_number;
+    int customers_served;
+    long start_time;
+    long end_time;
+    latency_t *latency;
+} teller_t; /* Teller struct. */
+
+/*************************************************************************
+ * Struct for a customer.
+ *
+ * This struct contains the customer number, the service type, the time
+ * the customer arrived in the queue, and the time the customer was
+ * finished being served by a teller.
+ *
+ * @param customer_number - The customer number.
+ * @param service_type - The service type.
+ * @param arrival_time - The CLOCK_MONOTONIC time the customer arrived in the queue, in ns.
+ * @param intended_time - The CLOCK_MONOTONIC time the customer was meant to arrive, in ns.
+ *                        It is earlier than arrival_time when the producer fell behind.
+ *************************************************************************/
+typedef struct customer {
+    long customer_number;
+    char service_type;
+    long arrival_time;
+    long intended_time;
+} customer_t; /* Customer struct. */
+
+/*************************************************************************
+ * Struct for a teller's local deque.
+ *
+ * The producer adds customers to the back and the owning teller takes
+ * them from the front. An idle teller steals from the back of another
+ * teller's deque. Each deque has its own lock, padded onto its own cache
+ * line, so tellers only contend when they steal.
+ *
+ * @param mutex - The lock for this deque.
+ * @param q - The customers in the deque.
+ * @param front - The position of the front customer.
+ * @param count - The number of customers in the deque.
+ * @param locks - The number of times the deque lock was taken.
+ *************************************************************************/
+typedef struct deque {
+    pthread_mutex_t mutex;
+    customer_t *q;
+    int front;
+    int count;
+    unsigned long locks;
+    char pad[CACHE_LINE];
+} deque_t; /* Deque struct. */
+
+/*************************************************************************
+ * Struct for a customer queue.
+ *
+ * This struct contains the customer queue, the size of the queue, the
+ * number of customers in the queue, the position to insert the next
+ * customer, and the position to remove the next customer.
+ *
+ * @param c_queue - The customer queue.
+ * @param c_queue.size - The size of the queue.
+ * @param c_queue.count - The number of customers in the queue.
+ * @param c_queue.in - The position to insert the next customer.
+ * @param c_queue.out - The position to remove the next customer.
+ * @param c_queue.type - The queue implementation (QUEUE_MUTEX or QUEUE_LOCKFREE).
+ * @param c_queue.ring - The lock-free ring, used instead of q for QUEUE_LOCKFREE.
+ * @param c_queue.end_of_file - TRUE once no more customers will be added.
+ * @param c_queue.sleepers - The number of tellers waiting on empty.
+ * @param c_queue.blocked - The number of producers waiting on full.
+ * @param c_queue.deques - The per-teller deques (QUEUE_STEAL).
+ * @param c_queue.n_deques - The number of per-teller deques (QUEUE_STEAL).
+ * @param c_queue.next - The deque the next customer is added to (QUEUE_STEAL).
+ * @param c_queue.sched - The per-service-type queues, used instead of q when a
+ *                        scheduling policy is set (QUEUE_MUTEX).
+ * @param c_queue.tellers - The number of tellers taking customers; tellers with a
+ *                          higher index are retired (see queue_scale()).
+ * @param c_queue.arrivals - The number of customers added so far.
+ * @param c_queue.producers - The number of producers that have not closed the queue.
+ * @param c_queue.locks - The number of times the queue mutex was taken.
+ * @param c_queue.wait - How the tellers and producers wait (see queue_wait()).
+ * @param c_queue.empty_seq - The futex word parked tellers wait on (WAIT_FUTEX, WAIT_ADAPTIVE).
+ * @param c_queue.full_seq - The futex word parked producers wait on (WAIT_FUTEX, WAIT_ADAPTIVE).
+ * @param c_queue.spun - The number of waits that ended while spinning (WAIT_ADAPTIVE).
+ * @param c_queue.parks - The number of times a teller or producer parked.
+ * @param c_queue.shared - TRUE if the queue is in memory shared with the teller
+ *                         processes (see queue_init_shared()).
+ * @param c_queue.patience - How long a customer waits before it reneges, in ns,
+ *                           or 0 to wait until served (see queue_patience()).
+ * @param c_queue.reneged - The number of customers that reneged.
+ *************************************************************************/
+typedef struct customer_queue {
+    customer_t *q;
+    int size;
+    int count;
+    int in;
+    int out;
+    pthread_mutex_t mutex;
+    pthread_cond_t empty;
+    pthread_cond_t full;
+    int type;
+    ring_t ring;
+    int end_of_file;
+    int sleepers;
+    int blocked;
+    struct deque *deques;
+    int n_deques;
+    unsigned long next;
+    struct sched *sched;
+    int tellers;
+    int producers;
+    unsigned long arrivals;
+    unsigned long locks;
+    wait_t wait;
+    int empty_seq;
+    int full_seq;
+    unsigned long spun;
+    unsigned long parks;
+    int shared;
+    long patience;
+    unsigned long reneged;
+} customer_queue_t; /* Customer queue struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+/* Helper functions. */
+void wrt_log(const char *msg);
+
+void debug(const char *msg);
+
+void init_clock(void);
+
+void format_time(long ns, char *time_str);
+
+long now_ns(void);
+
+void sleep_until(long deadline);
+
+void log_arrival(const customer_t *c);
+
+void log_departure(const customer_t *c, const char *reason, long time);
+
+void log_response(const teller_t *t, const customer_t *c, long response_time);
+
+void log_completion(const teller_t *t, const customer_t *c, long completion_time);
+
+void log_termination(const teller_t *t);
+
+void log_statistics(const teller_t *t, int n);
+
+void log_overload(unsigned long reneged);
+
+void log_placement(int n, const char *label);
+
+void log_waits(const wait_t *w, unsigned long spun, unsigned long parks);
+
+void log_locks(unsigned long locks, const teller_t *t, int n);
+
+void print_bench(const teller_t *t, int n, long elapsed, unsigned long locks);
+
+void log_latency_line(const char *name, const hist_t *h);
+
+void log_latency(const teller_t *t, int n, const char *label);
+
+void log_branches(const teller_t *t, int n);
+
+int overloaded(void);
+
+void usage(const char *name);
+
+void sig_handler(int signo);
+
+/* Thread functions. */
+void *teller(void *arg);
+
+void *worker(void *arg);
+
+void *customer(void *arg);
+
+void *controller(void *arg);
+
+void start_teller(int i);
+
+void start_group(int g);
+
+
+#endif /*OS_ASSIGNMENT_20183622_STANDARD_H*/
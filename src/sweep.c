@@ -0,0 +1,403 @@
+#include "sweep.h"
+#include <ctype.h> /* For isspace() */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Parse Field Function.
+ *
+ * This function reads the values of one field of a sweep line: a comma
+ * separated list of numbers and ranges, where lo-hi is every number from
+ * lo to hi and lo-hi:step every step-th one.
+ *
+ * @param field - The field.
+ * @param values - Filled with the values.
+ * @return int - The number of values, or 0 if the field is not valid.
+ *************************************************************************/
+static int parse_field(const char *field, int *values) {
+    const char *p = field;
+    char *end;
+    long lo, hi, step;
+    int n = 0;
+
+    for (;;) {
+        lo = strtol(p, &end, 10);
+        if (end == p) {
+            return 0;
+        }
+        hi = lo;
+        step = 1;
+        p = end;
+        if (*p == '-') {
+            hi = strtol(p + 1, &end, 10);
+            if (end == p + 1) {
+                return 0;
+            }
+            p = end;
+            if (*p == ':') {
+                step = strtol(p + 1, &end, 10);
+                if (end == p + 1 || step < 1) {
+                    return 0;
+                }
+                p = end;
+            }
+        }
+        for (; lo <= hi; lo += step) {
+            if (n == SWEEP_VALUES) {
+                return 0;
+            }
+            values[n++] = (int) lo;
+        }
+        if (*p == '\0') {
+            return n;
+        }
+        if (*p != ',') {
+            return 0;
+        }
+        p++;
+    }
+}
+
+/*************************************************************************
+ * Run Point Function.
+ *
+ * This function simulates one configuration of the sweep and fills in
+ * its result.
+ *
+ * @param sw - The sweep.
+ * @param pt - The configuration.
+ * @param merged - Scratch space for merging the tellers' histograms.
+ * @return void
+ *************************************************************************/
+static void run_point(const sweep_t *sw, sweep_point_t *pt, hist_t *merged) {
+    static const double percentiles[SWEEP_PERCENTILES] = {50.0, 90.0, 99.0, 99.9};
+    sim_config_t cfg = sw->base;
+    teller_t *tellers;
+    latency_t *latencies;
+    double busy = 0; /* The time the tellers spent serving, in ns. */
+    long end = 0; /* The virtual time the last teller finished. */
+    int n = pt->v[5];
+    int i, j; /* Loop counters. */
+
+    cfg.queue_size = pt->v[0];
+    cfg.t_C = pt->v[1];
+    cfg.tellers = n;
+    cfg.log = FALSE;
+    cfg.seed += (unsigned long) pt->rep;
+    tellers = calloc(n, sizeof(teller_t));
+    latencies = calloc(n, sizeof(latency_t));
+    pt->failed = TRUE;
+    if (tellers == NULL || latencies == NULL) {
+        free(tellers);
+        free(latencies);
+        return;
+    }
+    for (i = 0; i < n; i++) {
+        tellers[i].latency = &latencies[i];
+    }
+    for (i = 0; i < LAT_TYPES; i++) {
+        if (service_init(&cfg.service[i], pt->v[2 + i]) != 0) {
+            for (j = 0; j < i; j++) {
+                service_destroy(&cfg.service[j]);
+            }
+            free(tellers);
+            free(latencies);
+            return;
+        }
+    }
+
+    if (simulate(&cfg, tellers) == 0) {
+        pt->failed = FALSE;
+        pt->customers = 0;
+        for (i = 0; i < n; i++) {
+            pt->customers += tellers[i].customers_served;
+            if (tellers[i].end_time - tellers[i].start_time > end) {
+                end = tellers[i].end_time - tellers[i].start_time;
+            }
+            for (j = 0; j < LAT_TYPES; j++) {
+                busy += latencies[i].h[LAT_SERVICE][j].sum;
+            }
+        }
+        pt->seconds = end / 1e9;
+        pt->utilization = end > 0 ? busy / ((double) end * n) : 0.0;
+
+        memset(merged, 0, sizeof(hist_t));
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < LAT_TYPES; j++) {
+                hist_merge(merged, &latencies[i].h[LAT_WAIT][j]);
+            }
+        }
+        for (i = 0; i < SWEEP_PERCENTILES; i++) {
+            pt->wait[i] = hist_percentile(merged, percentiles[i]);
+        }
+        if (sw->percentile > 0 && sw->metric == LAT_WAIT) {
+            pt->target = hist_percentile(merged, sw->percentile);
+        }
+        memset(merged, 0, sizeof(hist_t));
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < LAT_TYPES; j++) {
+                hist_merge(merged, &latencies[i].h[LAT_TOTAL][j]);
+            }
+        }
+        pt->total_p99 = hist_percentile(merged, 99.0);
+        if (sw->percentile > 0 && sw->metric == LAT_TOTAL) {
+            pt->target = hist_percentile(merged, sw->percentile);
+        }
+    }
+
+    for (i = 0; i < LAT_TYPES; i++) {
+        service_destroy(&cfg.service[i]);
+    }
+    free(tellers);
+    free(latencies);
+}
+
+/*************************************************************************
+ * Sweep Worker Function.
+ *
+ * This function is the entry point of the sweep worker threads. Each
+ * claims the next point until none are left.
+ *
+ * @param arg - The sweep.
+ * @return void* - NULL.
+ *************************************************************************/
+static void *sweep_worker(void *arg) {
+    sweep_t *sw = (sweep_t *) arg;
+    hist_t *merged = malloc(sizeof(hist_t));
+    int i;
+
+    if (merged == NULL) {
+        return NULL;
+    }
+    while ((i = __atomic_fetch_add(&sw->next, 1, __ATOMIC_RELAXED)) < sw->n_points) {
+        run_point(sw, &sw->points[i], merged);
+    }
+    free(merged);
+    return NULL;
+}
+
+/*************************************************************************
+ *                             Sweep Functions                           *
+ *************************************************************************/
+
+/*************************************************************************
+ * Sweep Parse Function.
+ *
+ * This function reads the configurations of a sweep. Each line of the
+ * file is "<m> <t_C> <t_W> <t_D> <t_I> [tellers]", like the arguments of
+ * the program, and stands for every combination of the values of its
+ * fields; see parse_field(). A line without a teller count uses tellers.
+ * Blank lines and lines starting with '#' are skipped. The caller fills
+ * in sw->base.
+ *
+ * @param sw - The sweep to be filled in.
+ * @param path - The sweep file.
+ * @param tellers - The number of tellers for lines that do not give one.
+ * @return int - 0 on success, 1 if the file could not be read or a line
+ *               is not valid.
+ *************************************************************************/
+int sweep_parse(sweep_t *sw, const char *path, int tellers) {
+    char line[SWEEP_LINE];
+    char *field[SWEEP_FIELDS];
+    int *values = malloc(sizeof(int) * SWEEP_FIELDS * SWEEP_VALUES); /* The values of each field of a line. */
+    int count[SWEEP_FIELDS]; /* The number of values of each field. */
+    int at[SWEEP_FIELDS]; /* The value of each field in the combination being added. */
+    int size = 0; /* The number of points there is room for. */
+    int n_fields; /* The number of fields on the line. */
+    int n_line = 0; /* The line number. */
+    int failed = FALSE; /* TRUE once a line could not be read. */
+    sweep_point_t *grown;
+    char *p;
+    FILE *f;
+    int i; /* Loop counter. */
+
+    memset(sw, 0, sizeof(sweep_t));
+    f = fopen(path, "r");
+    if (f == NULL || values == NULL) {
+        printf("Error: Failed to open the sweep file %s.\n", path);
+        if (f != NULL) {
+            fclose(f);
+        }
+        free(values);
+        return 1;
+    }
+
+    while (failed == FALSE && fgets(line, SWEEP_LINE, f) != NULL) {
+        n_line++;
+        p = line;
+        while (isspace((unsigned char) *p)) {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        /* Split the line into its fields. */
+        n_fields = 0;
+        for (p = strtok(line, " \t\r\n"); p != NULL && n_fields < SWEEP_FIELDS; p = strtok(NULL, " \t\r\n")) {
+            field[n_fields++] = p;
+        }
+        if (p != NULL || n_fields < SWEEP_FIELDS - 1) {
+            printf("Error: Line %d of %s should be <m> <t_C> <t_W> <t_D> <t_I> [tellers].\n", n_line, path);
+            failed = TRUE;
+            break;
+        }
+        for (i = 0; i < SWEEP_FIELDS && failed == FALSE; i++) {
+            if (i == n_fields) {
+                values[i * SWEEP_VALUES] = tellers;
+                count[i] = 1;
+            } else {
+                count[i] = parse_field(field[i], &values[i * SWEEP_VALUES]);
+                if (count[i] == 0) {
+                    printf("Error: Field %d of line %d of %s is not valid: %s\n", i + 1, n_line, path, field[i]);
+                    failed = TRUE;
+                }
+            }
+        }
+
+        /* Add every combination, counting through the fields like an odometer. */
+        memset(at, 0, sizeof(at));
+        while (failed == FALSE) {
+            if (sw->n_points == size) {
+                size = size == 0 ? 64 : size * 2;
+                grown = realloc(sw->points, sizeof(sweep_point_t) * size);
+                if (grown == NULL) {
+                    printf("Error: Failed to allocate the sweep.\n");
+                    failed = TRUE;
+                    break;
+                }
+                sw->points = grown;
+            }
+            memset(&sw->points[sw->n_points], 0, sizeof(sweep_point_t));
+            for (i = 0; i < SWEEP_FIELDS; i++) {
+                sw->points[sw->n_points].v[i] = values[i * SWEEP_VALUES + at[i]];
+            }
+            sw->n_points++;
+
+            for (i = SWEEP_FIELDS - 1; i >= 0 && ++at[i] == count[i]; i--) {
+                at[i] = 0;
+            }
+            if (i < 0) {
+                break;
+            }
+        }
+    }
+
+    fclose(f);
+    free(values);
+    if (failed == FALSE) {
+        for (i = 0; i < sw->n_points; i++) {
+            if (sw->points[i].v[0] < 1 || sw->points[i].v[1] < 1 || sw->points[i].v[2] < 1 || sw->points[i].v[3] < 1
+                || sw->points[i].v[4] < 1 || sw->points[i].v[5] < 1) {
+                printf("Error: Every queue size, time period and teller count of a sweep must be at least 1.\n");
+                failed = TRUE;
+                break;
+            }
+        }
+    }
+    if (failed == TRUE || sw->n_points == 0) {
+        if (sw->n_points == 0 && failed == FALSE) {
+            printf("Error: The sweep file %s has no configurations.\n", path);
+        }
+        sweep_destroy(sw);
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Sweep Run Function.
+ *
+ * This function simulates every point of the sweep on a pool of worker
+ * threads. Each simulation runs on its own virtual clock with its own
+ * queue, tellers and generators, and writes no log, so the points run
+ * side by side without sharing anything but the read-only customer file.
+ *
+ * @param sw - The sweep.
+ * @param jobs - The number of worker threads, or 0 for one per online CPU.
+ * @return int - 0 if every point was simulated, 1 otherwise.
+ *************************************************************************/
+int sweep_run(sweep_t *sw, int jobs) {
+    pthread_t *threads;
+    int i; /* Loop counter. */
+
+    if (jobs <= 0) {
+        jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    jobs = jobs < 1 ? 1 : (jobs > sw->n_points ? sw->n_points : jobs);
+
+    threads = malloc(sizeof(pthread_t) * jobs);
+    if (threads == NULL) {
+        printf("Error: Failed to allocate the sweep workers.\n");
+        return 1;
+    }
+    /* A point no worker reaches, because none could be created, stays failed. */
+    for (i = 0; i < sw->n_points; i++) {
+        sw->points[i].failed = TRUE;
+    }
+    sw->next = 0;
+    for (i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[i], NULL, sweep_worker, sw) != 0) {
+            printf("Error: Failed to create sweep worker %d.\n", i + 1);
+            jobs = i;
+            break;
+        }
+    }
+    for (i = 0; i < jobs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    for (i = 0; i < sw->n_points; i++) {
+        if (sw->points[i].failed == TRUE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Sweep Print Function.
+ *
+ * This function writes the results as CSV, one line per point in the
+ * order of the sweep file. Latencies are in milliseconds, throughput is
+ * in customers per virtual second, and a point that could not be
+ * simulated has empty results.
+ *
+ * @param sw - The sweep.
+ * @param out - The file to write to.
+ * @return void
+ *************************************************************************/
+void sweep_print(const sweep_t *sw, FILE *out) {
+    const sweep_point_t *pt;
+    int i; /* Loop counter. */
+
+    fprintf(out, "m,t_C,t_W,t_D,t_I,tellers,customers,seconds,throughput,utilization,"
+                 "wait_p50_ms,wait_p90_ms,wait_p99_ms,wait_p999_ms,total_p99_ms\n");
+    for (i = 0; i < sw->n_points; i++) {
+        pt = &sw->points[i];
+        fprintf(out, "%d,%d,%d,%d,%d,%d,", pt->v[0], pt->v[1], pt->v[2], pt->v[3], pt->v[4], pt->v[5]);
+        if (pt->failed == TRUE) {
+            fprintf(out, ",,,,,,,,\n");
+            continue;
+        }
+        fprintf(out, "%ld,%.3f,%.3f,%.4f,%.3f,%.3f,%.3f,%.3f,%.3f\n", pt->customers, pt->seconds,
+                pt->seconds > 0 ? pt->customers / pt->seconds : 0.0, pt->utilization, pt->wait[0] / 1e6,
+                pt->wait[1] / 1e6, pt->wait[2] / 1e6, pt->wait[3] / 1e6, pt->total_p99 / 1e6);
+    }
+}
+
+/*************************************************************************
+ * Sweep Destroy Function.
+ *
+ * @param sw - The sweep to be freed. Its base configuration belongs to
+ *             the caller.
+ * @return void
+ *************************************************************************/
+void sweep_destroy(sweep_t *sw) {
+    free(sw->points);
+    sw->points = NULL;
+    sw->n_points = 0;
+}
@@ -0,0 +1,78 @@
+#ifndef OS_ASSIGNMENT_20183622_SWEEP_H
+#define OS_ASSIGNMENT_20183622_SWEEP_H
+
+#include "sim.h"
+
+#define SWEEP_FIELDS 6 /* m, t_C, t_W, t_D, t_I and the number of tellers. */
+#define SWEEP_LINE 256 /* The longest line of a sweep file. */
+#define SWEEP_VALUES 256 /* The most values one field of a line can take. */
+#define SWEEP_PERCENTILES 4 /* The wait percentiles reported: p50, p90, p99 and p99.9. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for one configuration of a sweep and its result.
+ *
+ * @param v - The queue size, t_C, t_W, t_D, t_I and the number of tellers.
+ * @param customers - The number of customers served.
+ * @param seconds - The virtual length of the run, in seconds.
+ * @param utilization - The fraction of the tellers' time spent serving.
+ * @param wait - The 50th, 90th, 99th and 99.9th percentile queue waits, in ns.
+ * @param total_p99 - The 99th percentile end-to-end time, in ns.
+ * @param target - The percentile of the sweep's target metric, in ns
+ *                 (see sweep_t).
+ * @param rep - The replica of the configuration, added to the seed.
+ * @param failed - TRUE if the run could not be made.
+ *************************************************************************/
+typedef struct sweep_point {
+    int v[SWEEP_FIELDS];
+    long customers;
+    double seconds;
+    double utilization;
+    unsigned long wait[SWEEP_PERCENTILES];
+    unsigned long total_p99;
+    unsigned long target;
+    int rep;
+    int failed;
+} sweep_point_t; /* Sweep point struct. */
+
+/*************************************************************************
+ * Struct for a parameter sweep.
+ *
+ * Every point is simulated on its own, from a copy of base, by one of
+ * the worker threads, which claim the points in order with an atomic
+ * counter. The workers share nothing else.
+ *
+ * @param base - The settings every point shares: the service time
+ *               distributions (before service_init()), the policy, the
+ *               arrivals and the seed.
+ * @param points - The configurations.
+ * @param n_points - The number of configurations.
+ * @param metric - LAT_WAIT or LAT_TOTAL, the metric put in each point's target.
+ * @param percentile - The percentile put in each point's target, or 0 for none.
+ * @param next - The index of the next point to be claimed.
+ *************************************************************************/
+typedef struct sweep {
+    sim_config_t base;
+    sweep_point_t *points;
+    int n_points;
+    int metric;
+    double percentile;
+    int next;
+} sweep_t; /* Sweep struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int sweep_parse(sweep_t *sw, const char *path, int tellers);
+
+int sweep_run(sweep_t *sw, int jobs);
+
+void sweep_print(const sweep_t *sw, FILE *out);
+
+void sweep_destroy(sweep_t *sw);
+
+#endif /*OS_ASSIGNMENT_20183622_SWEEP_H*/
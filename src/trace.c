@@ -0,0 +1,223 @@
+#include "trace.h"
+#include "standard.h"
+
+/*************************************************************************
+ *                            Global Variables                           *
+ *************************************************************************/
+
+static FILE *trace_file = NULL; /* The trace file, or NULL if tracing is off. */
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER; /* Mutex for writing the trace file. */
+static long trace_base; /* The time the trace starts at, in ns. */
+static int trace_first = TRUE; /* TRUE until the first event has been written. */
+static __thread trace_buf_t *trace_self = NULL; /* The buffer of the calling thread, or NULL if it does not trace. */
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Write Events Function.
+ *
+ * This function formats the buffered events of a thread as Chrome Trace
+ * Event JSON and appends them to the trace file. Times are given in
+ * microseconds from the start of the trace, printed from the integer
+ * nanoseconds, which is much cheaper than printing doubles. Every track
+ * is in process 1, a teller's track has the teller number as its thread
+ * id, and the counters are process-wide.
+ *
+ * @param b - The buffer, which is emptied.
+ * @return void
+ *************************************************************************/
+static void write_events(trace_buf_t *b) {
+    static const char *counters[] = {"Queue depth", "Producers blocked"};
+    const trace_event_t *e;
+    int i; /* Loop counter. */
+
+    pthread_mutex_lock(&trace_mutex);
+    for (i = 0; i < b->n; i++) {
+        e = &b->ev[i];
+        fputs(trace_first == TRUE ? "\n" : ",\n", trace_file);
+        trace_first = FALSE;
+        if (e->kind == TRACE_SPAN) {
+            fprintf(trace_file,
+                    "{\"name\":\"%c\",\"cat\":\"service\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%ld.%03ld,"
+                    "\"dur\":%ld.%03ld,\"args\":{\"customer\":%ld}}",
+                    e->type, e->track, (e->ts - trace_base) / 1000, (e->ts - trace_base) % 1000, e->dur / 1000,
+                    e->dur % 1000, e->value);
+        } else if (e->kind == TRACE_NAME) {
+            fprintf(trace_file,
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Teller-%d\"}},\n"
+                    "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+                    e->track, e->track, e->track, e->track);
+        } else {
+            fprintf(trace_file, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%ld.%03ld,\"args\":{\"value\":%ld}}",
+                    counters[(int) e->type], (e->ts - trace_base) / 1000, (e->ts - trace_base) % 1000, e->value);
+        }
+    }
+    pthread_mutex_unlock(&trace_mutex);
+    b->n = 0;
+}
+
+/*************************************************************************
+ * Next Event Function.
+ *
+ * @return trace_event_t* - The next free event of the calling thread's
+ *                          buffer, writing the buffer out first if it is
+ *                          full.
+ *************************************************************************/
+static trace_event_t *next_event(void) {
+    if (trace_self->n == TRACE_BUF) {
+        write_events(trace_self);
+    }
+    return &trace_self->ev[trace_self->n++];
+}
+
+/*************************************************************************
+ *                            Trace Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Trace Open Function.
+ *
+ * This function creates the trace file and turns tracing on. The threads
+ * that should be traced then call trace_attach().
+ *
+ * @param path - The trace file.
+ * @param base - The time the trace starts at, in ns.
+ * @return int - 0 on success, 1 if the file could not be created.
+ *************************************************************************/
+int trace_open(const char *path, long base) {
+    trace_file = fopen(path, "w");
+    if (trace_file == NULL) {
+        printf("Error: Failed to create the trace file %s.\n", path);
+        return 1;
+    }
+    trace_base = base;
+    trace_first = TRUE;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", trace_file);
+    fputs("\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Bank\"}}", trace_file);
+    trace_first = FALSE;
+    return 0;
+}
+
+/*************************************************************************
+ * Trace Close Function.
+ *
+ * This function ends the trace file. It must be called after every
+ * traced thread has called trace_detach().
+ *
+ * @return void
+ *************************************************************************/
+void trace_close(void) {
+    if (trace_file == NULL) {
+        return;
+    }
+    fputs("\n]}\n", trace_file);
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/*************************************************************************
+ * Trace Attach Function.
+ *
+ * This function gives the calling thread a buffer, so its events are
+ * recorded. It does nothing if tracing is off.
+ *
+ * @return void
+ *************************************************************************/
+void trace_attach(void) {
+    if (trace_file == NULL || trace_self != NULL) {
+        return;
+    }
+    trace_self = malloc(sizeof(trace_buf_t));
+    if (trace_self != NULL) {
+        trace_self->n = 0;
+    }
+}
+
+/*************************************************************************
+ * Trace Detach Function.
+ *
+ * This function writes out the events of the calling thread and frees
+ * its buffer. It must be called before the thread exits.
+ *
+ * @return void
+ *************************************************************************/
+void trace_detach(void) {
+    if (trace_self == NULL) {
+        return;
+    }
+    write_events(trace_self);
+    free(trace_self);
+    trace_self = NULL;
+}
+
+/*************************************************************************
+ * Trace Name Function.
+ *
+ * This function names the track of a teller "Teller-N" and sorts the
+ * tracks by teller number.
+ *
+ * @param track - The teller number.
+ * @return void
+ *************************************************************************/
+void trace_name(int track) {
+    trace_event_t *e;
+
+    if (trace_self == NULL) {
+        return;
+    }
+    e = next_event();
+    e->kind = TRACE_NAME;
+    e->track = track;
+}
+
+/*************************************************************************
+ * Trace Span Function.
+ *
+ * This function records a teller serving a customer.
+ *
+ * @param track - The teller number.
+ * @param type - The service type.
+ * @param customer - The customer number.
+ * @param start - The time the teller took the customer, in ns.
+ * @param end - The time the service ended, in ns.
+ * @return void
+ *************************************************************************/
+void trace_span(int track, char type, long customer, long start, long end) {
+    trace_event_t *e;
+
+    if (trace_self == NULL) {
+        return;
+    }
+    e = next_event();
+    e->kind = TRACE_SPAN;
+    e->type = type;
+    e->track = track;
+    e->ts = start;
+    e->dur = end - start;
+    e->value = customer;
+}
+
+/*************************************************************************
+ * Trace Counter Function.
+ *
+ * This function records a new value of a counter track, at the current
+ * time. The clock is only read when the calling thread is traced.
+ *
+ * @param counter - TRACE_QUEUE or TRACE_BLOCKED.
+ * @param value - The value of the counter.
+ * @return void
+ *************************************************************************/
+void trace_counter(int counter, long value) {
+    trace_event_t *e;
+
+    if (trace_self == NULL) {
+        return;
+    }
+    e = next_event();
+    e->kind = TRACE_COUNTER;
+    e->type = (char) counter;
+    e->ts = now_ns();
+    e->value = value;
+}
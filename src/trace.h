@@ -0,0 +1,68 @@
+#ifndef OS_ASSIGNMENT_20183622_TRACE_H
+#define OS_ASSIGNMENT_20183622_TRACE_H
+
+#define TRACE_BUF 1024 /* The number of events a thread buffers before it writes them out. */
+
+#define TRACE_SPAN 0 /* A teller serving a customer. */
+#define TRACE_NAME 1 /* The name of a teller's track. */
+#define TRACE_COUNTER 2 /* A new value of a counter track. */
+
+#define TRACE_QUEUE 0 /* The counter of the customers waiting in the queue. */
+#define TRACE_BLOCKED 1 /* The counter of the producers blocked on a full queue. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a trace event.
+ *
+ * Events are kept as numbers and only formatted as JSON when the buffer
+ * is written out, so recording one is a few stores.
+ *
+ * @param kind - TRACE_SPAN, TRACE_NAME or TRACE_COUNTER.
+ * @param type - The service type of a span, or the counter of a counter event.
+ * @param track - The teller number of a span or a name.
+ * @param ts - The CLOCK_MONOTONIC time of the event, in ns.
+ * @param dur - The length of a span, in ns.
+ * @param value - The customer number of a span, or the value of a counter.
+ *************************************************************************/
+typedef struct trace_event {
+    char kind;
+    char type;
+    int track;
+    long ts;
+    long dur;
+    long value;
+} trace_event_t; /* Trace event struct. */
+
+/*************************************************************************
+ * Struct for the trace events buffered by one thread.
+ *
+ * @param n - The number of events in the buffer.
+ * @param ev - The events.
+ *************************************************************************/
+typedef struct trace_buf {
+    int n;
+    trace_event_t ev[TRACE_BUF];
+} trace_buf_t; /* Trace buffer struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int trace_open(const char *path, long base);
+
+void trace_close(void);
+
+void trace_attach(void);
+
+void trace_detach(void);
+
+void trace_name(int track);
+
+void trace_span(int track, char type, long customer, long start, long end);
+
+void trace_counter(int counter, long value);
+
+#endif /*OS_ASSIGNMENT_20183622_TRACE_H*/
@@ -0,0 +1,139 @@
+/* Expose syscall() and sched_yield() while compiling as c89. */
+#define _GNU_SOURCE
+
+#include "wait.h"
+#include <linux/futex.h>
+#include <sched.h>
+#include <stdlib.h> /* For strtol() */
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h> /* For struct timespec */
+#include <unistd.h>
+
+/*************************************************************************
+ *                             Wait Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Wait Parse Function.
+ *
+ * This function reads a wait strategy as given on the command line:
+ * "condvar", "futex" or "adaptive[:spins[:yields]]".
+ *
+ * @param arg - The argument.
+ * @param w - Filled with the wait strategy.
+ * @return int - 0 on success, 1 if the argument is not valid.
+ *************************************************************************/
+int wait_parse(const char *arg, wait_t *w) {
+    const char *p; /* The next number. */
+    char *end; /* The end of the number read. */
+
+    w->spins = WAIT_SPINS;
+    w->yields = WAIT_YIELDS;
+    if (strcmp(arg, "condvar") == 0) {
+        w->type = WAIT_CONDVAR;
+        return 0;
+    }
+    if (strcmp(arg, "futex") == 0) {
+        w->type = WAIT_FUTEX;
+        return 0;
+    }
+    if (strncmp(arg, "adaptive", 8) != 0 || (arg[8] != '\0' && arg[8] != ':')) {
+        return 1;
+    }
+
+    w->type = WAIT_ADAPTIVE;
+    if (arg[8] == ':') {
+        p = arg + 9;
+        w->spins = (int) strtol(p, &end, 10);
+        if (end == p || (*end != '\0' && *end != ':') || w->spins < 0) {
+            return 1;
+        }
+        if (*end == ':') {
+            p = end + 1;
+            w->yields = (int) strtol(p, &end, 10);
+            if (end == p || *end != '\0' || w->yields < 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Wait Name Function.
+ *
+ * @param type - The wait strategy.
+ * @return const char* - The name of the wait strategy, for the log.
+ *************************************************************************/
+const char *wait_name(int type) {
+    if (type == WAIT_FUTEX) {
+        return "futex";
+    } else if (type == WAIT_ADAPTIVE) {
+        return "adaptive";
+    }
+    return "condvar";
+}
+
+/*************************************************************************
+ * Wait Relax Function.
+ *
+ * This function tells the CPU the thread is spinning, which saves power
+ * and lets a sibling hyper-thread run.
+ *
+ * @return void
+ *************************************************************************/
+void wait_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*************************************************************************
+ * Wait Yield Function.
+ *
+ * @return void
+ *************************************************************************/
+void wait_yield(void) {
+    sched_yield();
+}
+
+/*************************************************************************
+ * Futex Wait Function.
+ *
+ * This function sleeps while *addr is val. It can also return early, on
+ * a signal or a spurious wakeup, so the caller checks again.
+ *
+ * @param addr - The futex word.
+ * @param val - The value the caller saw before it decided to sleep.
+ * @param timeout - The most time to sleep for, in ns, or -1 to sleep
+ *                  until woken.
+ * @param shared - TRUE if the word is in memory shared with other processes.
+ * @return void
+ *************************************************************************/
+void futex_wait(int *addr, int val, long timeout, int shared) {
+    struct timespec ts;
+    int op = shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+
+    if (timeout < 0) {
+        syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+        return;
+    }
+    ts.tv_sec = timeout / 1000000000L;
+    ts.tv_nsec = timeout % 1000000000L;
+    syscall(SYS_futex, addr, op, val, &ts, NULL, 0);
+}
+
+/*************************************************************************
+ * Futex Wake Function.
+ *
+ * @param addr - The futex word.
+ * @param n - The most threads to wake.
+ * @param shared - TRUE if the word is in memory shared with other processes.
+ * @return void
+ *************************************************************************/
+void futex_wake(int *addr, int n, int shared) {
+    syscall(SYS_futex, addr, shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
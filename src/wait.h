@@ -0,0 +1,55 @@
+#ifndef OS_ASSIGNMENT_20183622_WAIT_H
+#define OS_ASSIGNMENT_20183622_WAIT_H
+
+#define WAIT_CONDVAR 0 /* Park on the queue's condition variables (the default). */
+#define WAIT_FUTEX 1 /* Park on a futex, without taking the queue mutex. */
+#define WAIT_ADAPTIVE 2 /* Spin, then yield, then park on a futex. */
+
+#define WAIT_SPINS 2000 /* The default number of checks an adaptive wait spins for (a few microseconds). */
+#define WAIT_YIELDS 4 /* The default number of times an adaptive wait yields the CPU before it parks. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for how a thread waits on the customer queue.
+ *
+ * A short gap between arrivals is cheaper to wait out on the CPU than to
+ * sleep through: a parked thread needs a system call to be woken and the
+ * scheduler to run it again. An adaptive wait checks the queue for a
+ * bounded number of spins, then gives up the CPU a few times, and only
+ * then parks. The spin is wasted on a single CPU, where the thread that
+ * would end the wait cannot run, so it should only be used with spare
+ * cores.
+ *
+ * @param type - WAIT_CONDVAR, WAIT_FUTEX or WAIT_ADAPTIVE.
+ * @param spins - The number of times to check before yielding (WAIT_ADAPTIVE).
+ * @param yields - The number of times to yield before parking (WAIT_ADAPTIVE).
+ * @param shared - TRUE if the waiters can be in other processes, so the
+ *                 futexes must not be process-private.
+ *************************************************************************/
+typedef struct wait {
+    int type;
+    int spins;
+    int yields;
+    int shared;
+} wait_t; /* Wait strategy struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int wait_parse(const char *arg, wait_t *w);
+
+const char *wait_name(int type);
+
+void wait_relax(void);
+
+void wait_yield(void);
+
+void futex_wait(int *addr, int val, long timeout, int shared);
+
+void futex_wake(int *addr, int n, int shared);
+
+#endif /*OS_ASSIGNMENT_20183622_WAIT_H*/
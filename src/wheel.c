@@ -0,0 +1,204 @@
+#include "wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/*************************************************************************
+ *                           Helper Functions                            *
+ *************************************************************************/
+
+/*************************************************************************
+ * Place Timer Function.
+ *
+ * This function puts a timer in the slot for its expiry: the lowest level
+ * whose current lap holds it, or the due list if it has already expired.
+ * A timer beyond the top level's lap goes in the last top level slot the
+ * wheel reaches before the timer, and is placed again from there.
+ *
+ * @param w - The wheel.
+ * @param id - The timer.
+ * @return void
+ *************************************************************************/
+static void place(wheel_t *w, int id) {
+    long t = w->expiry[id];
+    long last; /* The last top level slot of the lap, counted from tick 0. */
+    int level; /* The level the timer goes in. */
+    int slot; /* The slot the timer goes in. */
+
+    if (t <= w->tick) {
+        w->next[id] = w->due;
+        w->due = id;
+        return;
+    }
+
+    for (level = 0; level < WHEEL_LEVELS; level++) {
+        if (t >> (WHEEL_BITS * (level + 1)) == w->tick >> (WHEEL_BITS * (level + 1))) {
+            break;
+        }
+    }
+
+    /* Beyond the top level's lap, wait in the last slot before the timer and be placed again from there. */
+    if (level == WHEEL_LEVELS) {
+        level = WHEEL_LEVELS - 1;
+        last = (w->tick >> (WHEEL_BITS * level)) + WHEEL_SLOTS - 1;
+        t >>= WHEEL_BITS * level;
+        t = t < last ? t : last;
+    } else {
+        t >>= WHEEL_BITS * level;
+    }
+    slot = (int) (t & WHEEL_MASK);
+    w->next[id] = w->slots[level][slot];
+    w->slots[level][slot] = id;
+}
+
+/*************************************************************************
+ * Advance Function.
+ *
+ * This function moves the wheel on by one tick. The slots of the upper
+ * levels whose laps start on the new tick are placed again, and the level
+ * 0 slot of the new tick joins the due list.
+ *
+ * @param w - The wheel.
+ * @return void
+ *************************************************************************/
+static void advance(wheel_t *w) {
+    int level; /* Loop counter. */
+    int id, next; /* The timers of a slot. */
+    int slot;
+
+    w->tick++;
+    for (level = WHEEL_LEVELS - 1; level >= 0; level--) {
+        if (level > 0 && (w->tick & ((1L << (WHEEL_BITS * level)) - 1)) != 0) {
+            continue;
+        }
+        slot = (int) ((w->tick >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        id = w->slots[level][slot];
+        w->slots[level][slot] = -1;
+        for (; id >= 0; id = next) {
+            next = w->next[id];
+            place(w, id);
+        }
+    }
+}
+
+/*************************************************************************
+ *                         Timing Wheel Functions                        *
+ *************************************************************************/
+
+/*************************************************************************
+ * Wheel Init Function.
+ *
+ * @param w - The wheel to be initialized.
+ * @param n - The number of timer ids, from 0 to n - 1.
+ * @param now - The current time, in ns.
+ * @return int - 0 on success, 1 on failure.
+ *************************************************************************/
+int wheel_init(wheel_t *w, int n, long now) {
+    memset(w->slots, -1, sizeof(w->slots));
+    w->tick = now / WHEEL_TICK_NS;
+    w->due = -1;
+    w->count = 0;
+    w->next = malloc(sizeof(int) * (n > 0 ? n : 1));
+    w->expiry = malloc(sizeof(long) * (n > 0 ? n : 1));
+    if (w->next == NULL || w->expiry == NULL) {
+        printf("Error: Failed to allocate the timing wheel.\n");
+        wheel_destroy(w);
+        return 1;
+    }
+    return 0;
+}
+
+/*************************************************************************
+ * Wheel Destroy Function.
+ *
+ * @param w - The wheel to be destroyed.
+ * @return void
+ *************************************************************************/
+void wheel_destroy(wheel_t *w) {
+    free(w->next);
+    free(w->expiry);
+    w->next = NULL;
+    w->expiry = NULL;
+}
+
+/*************************************************************************
+ * Wheel Add Function.
+ *
+ * @param w - The wheel.
+ * @param id - The timer, which must not be in the wheel.
+ * @param deadline - The time the timer expires, in ns. It is rounded up
+ *                   to the next tick, so a timer never expires early.
+ * @return void
+ *************************************************************************/
+void wheel_add(wheel_t *w, int id, long deadline) {
+    w->expiry[id] = (deadline + WHEEL_TICK_NS - 1) / WHEEL_TICK_NS;
+    w->count++;
+    place(w, id);
+}
+
+/*************************************************************************
+ * Wheel Expire Function.
+ *
+ * This function moves the wheel on to now and returns one expired timer.
+ * Call it until it returns -1 to take every expired timer.
+ *
+ * @param w - The wheel.
+ * @param now - The current time, in ns.
+ * @return int - An expired timer, which has left the wheel, or -1 if no
+ *               timer has expired.
+ *************************************************************************/
+int wheel_expire(wheel_t *w, long now) {
+    long target = now / WHEEL_TICK_NS;
+    int id;
+
+    if (w->count == 0) {
+        /* Nothing to move down or expire, so jump straight to now. */
+        if (target > w->tick) {
+            w->tick = target;
+        }
+        return -1;
+    }
+
+    while (w->due < 0 && w->tick < target) {
+        advance(w);
+    }
+    if (w->due < 0) {
+        return -1;
+    }
+
+    id = w->due;
+    w->due = w->next[id];
+    w->count--;
+    return id;
+}
+
+/*************************************************************************
+ * Wheel Next Function.
+ *
+ * This function finds when wheel_expire() should next be called: the tick
+ * of the next busy level 0 slot in the current lap, or else the start of
+ * the next lap, when timers move down from the levels above.
+ *
+ * @param w - The wheel.
+ * @return long - The time, in ns, or -1 if the wheel is empty. A time in
+ *                the past means timers are already due.
+ *************************************************************************/
+long wheel_next(const wheel_t *w) {
+    long tick;
+
+    if (w->count == 0) {
+        return -1;
+    }
+    if (w->due >= 0) {
+        return w->tick * WHEEL_TICK_NS;
+    }
+
+    for (tick = w->tick + 1; (tick & WHEEL_MASK) != 0; tick++) {
+        if (w->slots[0][tick & WHEEL_MASK] >= 0) {
+            return tick * WHEEL_TICK_NS;
+        }
+    }
+    return tick * WHEEL_TICK_NS;
+}
@@ -0,0 +1,55 @@
+#ifndef OS_ASSIGNMENT_20183622_WHEEL_H
+#define OS_ASSIGNMENT_20183622_WHEEL_H
+
+#define WHEEL_TICK_NS 1000000L /* The resolution of the wheel, 1ms. */
+#define WHEEL_BITS 6 /* Each level has 2^WHEEL_BITS slots. */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4 /* Enough for 2^24 ticks (about 4.6 hours) before a timer is parked on the top level. */
+
+/*************************************************************************
+ *                                Structs                                *
+ *************************************************************************/
+
+/*************************************************************************
+ * Struct for a hierarchical timing wheel.
+ *
+ * A timer is one of a fixed set of ids (one per teller), so the lists of
+ * timers are kept as indices into the next array and adding, cancelling
+ * and expiring a timer never allocates. Level 0 has a slot per tick, and
+ * each level above has a slot per lap of the level below. A timer goes in
+ * the lowest level whose lap it falls in, and is moved down a level each
+ * time the wheel reaches its slot, so every timer is touched at most once
+ * per level. Timers expire on the first tick at or after their deadline.
+ *
+ * @param tick - The current tick. Every timer before it has expired.
+ * @param slots - The first timer in each slot of each level, or -1.
+ * @param next - The timer after each timer in its list, or -1.
+ * @param expiry - The tick each timer expires on.
+ * @param due - The first of the timers that have expired but not been
+ *              returned by wheel_expire(), or -1.
+ * @param count - The number of timers in the wheel, including the due ones.
+ *************************************************************************/
+typedef struct wheel {
+    long tick;
+    int slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    int *next;
+    long *expiry;
+    int due;
+    int count;
+} wheel_t; /* Timing wheel struct. */
+
+/*************************************************************************
+*                          Function Prototypes                          *
+*************************************************************************/
+
+int wheel_init(wheel_t *w, int n, long now);
+
+void wheel_destroy(wheel_t *w);
+
+void wheel_add(wheel_t *w, int id, long deadline);
+
+int wheel_expire(wheel_t *w, long now);
+
+long wheel_next(const wheel_t *w);
+
+#endif /*OS_ASSIGNMENT_20183622_WHEEL_H*/